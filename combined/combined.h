@@ -4,27 +4,30 @@
 #ifndef COMBINED_H
 #define COMBINED_H
 
-enum Role{winner=1, loser=2, bye=3, champion=4, dropout=5};
+// fused barrier + allreduce: up to a cache line of doubles per call; the
+// payload slots and the tournament's message buffers are sized for it, and
+// combined_allreduce/gtmpi_allreduce abort the job on a larger n
+#define COMBINED_MAX_PAYLOAD 8
+#define COMBINED_REDUCE_TAG 1
 
-typedef struct{
-    enum Role role;
-    int opponent; 
-    bool flag;
-} tournament_round_t;
+enum combined_op{combined_sum=1, combined_min=2, combined_max=3};
 
-extern tournament_round_t **tournament_rounds;
-extern int vpid;
-extern bool sense;
-extern int P;
-extern int num_tournament_rounds;
-
-extern int s_P;
-extern int count;
-extern bool s_sense;
+// MPI thread support the barrier needs (MPI_Init_thread "required")
+extern const int combined_thread_level;
 
 void combined_init(int num_processes, int num_threads);
-void combined_barrier(); 
-void gtmpi_barrier();
+void combined_barrier();
+void combined_allreduce(double *values, int n, enum combined_op op);
 void combined_finalize();
 
+// tournament.c
+void tournament_init(int num_processes);
+void tournament_finalize();
+void gtmpi_barrier();
+void gtmpi_allreduce(double *values, int n, enum combined_op op);
+
+// payload.c
+void combine_payload(double *acc, const double *in, int n, enum combined_op op);
+void combined_payload_check(int n);
+
 #endif
@@ -1,122 +1,99 @@
 #include <stdlib.h>
+#include <string.h>
 #include <mpi.h>
 #include <omp.h>
 #include <stdio.h>
 #include "combined.h"
+#include "combined_trace.h"
+#include "gtarena.h"
+#include "gtspin.h"
 
-/*=============================================================
-Tournament barrier
-=============================================================*/
-int P; // num_processes
-int vpid; // process id
-int num_tournament_rounds;
-tournament_round_t **tournament_rounds;
-bool sense;
-
+// only the master thread talks to MPI
+const int combined_thread_level = MPI_THREAD_FUNNELED;
 
 /*=============================================================
 Dissemination barrier
 =============================================================*/
 static int rounds;
-static int **flags;
 static int n_threads;
+static int generation;  // bumped by combined_init
+static int released;    // episodes the master has closed on the MPI side
+static int parity = 0;
+static int local_sense = 1;
+static int episode = 0; // this thread's combined_barrier calls
+static int joined = 0;  // generation this thread's private state belongs to
+#pragma omp threadprivate(parity, local_sense, episode, joined)
+
+/*=============================================================
+Allreduce payload: one cache line per thread
+=============================================================*/
+typedef struct{
+    double v[COMBINED_MAX_PAYLOAD];
+} payload_t;
+
+static double result[COMBINED_MAX_PAYLOAD];
+
+/*=============================================================
+Thread state: one arena region per thread (GT_ARENA, see
+gtarena.h), its flags[parity][round] then its payload slot
+=============================================================*/
+static gtarena_t arena;
+static size_t flag_row; // bytes of flags in front of the payload
+
+static inline int *flags(int thread_id){
+    return (int*)gtarena_region(&arena, thread_id);
+}
+
+static inline payload_t *payload(int thread_id){
+    return (payload_t*)((char*)gtarena_region(&arena, thread_id) + flag_row);
+}
 
-void gtmpi_barrier();
 void combined_init(int num_processes, int num_threads){
     /*=============================================================
     Dissemination barrier
     =============================================================*/
     n_threads = num_threads;
     rounds = (int)ceil(log2(num_threads)); // log2(P) rounds
+    generation++;
+    released = 0;
 
-    // allocate memory for flags: flags[thread_id][parity][round]
-    flags = (int**)malloc(n_threads * sizeof(int*));
-    for (int i = 0; i < n_threads; i++)
-    {
-        flags[i] = (int*)malloc(2 * rounds * sizeof(int));
-        for (int j = 0; j < 2 * rounds; j++)
-        {
-            flags[i][j] = 0; // initialize all flags to 0
-        }
-    }
+    // flags[thread_id][parity][round] and payload slots, all zeroed
+    flag_row = GTARENA_SIZE(2 * rounds * sizeof(int));
+    gtarena_begin(&arena, n_threads, flag_row + sizeof(payload_t), 0);
 
     /*=============================================================
     Tournament barrier
     =============================================================*/
-    P = num_processes;
-    num_tournament_rounds = ceil(log2(P));
-    MPI_Comm_rank(MPI_COMM_WORLD, &vpid);
-    sense = true;
-
-    tournament_rounds = (tournament_round_t **)calloc(P, sizeof(tournament_round_t *));
-    for(int i=0; i< P; i++){
-        tournament_rounds[i] = (tournament_round_t *)calloc(num_tournament_rounds+1, sizeof(tournament_round_t));
-    }
-
-    for(int i=0; i<P; i++){
-        for(int k=0; k<num_tournament_rounds+1; k++){
-            // init flag to false;
-            tournament_rounds[i][k].flag = false;
-
-            // init role;
-            if(k > 0){ 
-                if(i % (int)pow(2,k) == 0){ // bye or winner
-                    if( (i + (int)pow(2,k-1) < P) && ((int)pow(2,k) < P)){ //  && not last round
-                        tournament_rounds[i][k].role = winner;
-                    } else if(i + (int)pow(2,k-1) >= P){ // not available in this round // !review again
-                        tournament_rounds[i][k].role = bye;
-                    }
-                } 
-
-                if(i % (int)pow(2,k) == (int)pow(2,k-1)){ // loser
-                    tournament_rounds[i][k].role = loser;
-                }
-                
-                if( (i == 0) && ((int)pow(2,k) >= P) ){ // champion when root proc && when last round
-                    tournament_rounds[i][k].role = champion;
-                }
-            }else if(k==0){ // dropout
-                tournament_rounds[i][k].role = dropout;
-            }
-
-            // init opponent;
-            switch(tournament_rounds[i][k].role)
-            {
-                case loser: // loser point to its winner
-                    tournament_rounds[i][k].opponent = i - (int)pow(2,k-1); // opponent to MPI_Send
-                    break;
-                case winner: // winner and champion point to its loser
-                case champion: 
-                    tournament_rounds[i][k].opponent = i + (int)pow(2,k-1);
-                    break;        
-                case dropout: // not needed
-                    tournament_rounds[i][k].opponent = -1;
-                    break;
-                case bye: // not needed
-                    tournament_rounds[i][k].opponent = -1;
-                    break;
-            }
-        }
-    }
+    tournament_init(num_processes);
+    gtspin_init();
 }
 
-void combined_barrier(){
-    /*=============================================================
-    Dissemination barrier
-    =============================================================*/
-    int thread_id = omp_get_thread_num();
-    int local_sense = 0;
-    int parity = 0; // start with parity 0
+/*
+    parity and local_sense persist across episodes (threadprivate);
+    resetting them on every call lets the flags from the previous
+    episode satisfy the spin and the barrier stops blocking. They are
+    reset once, on a thread's first call after combined_init zeroed the
+    flags, because they also outlive combined_finalize.
+*/
+static void dissemination_barrier(int thread_id){
+    if (joined != generation)
+    {
+        joined = generation;
+        parity = 0;
+        local_sense = 1;
+        episode = 0;
+        gtarena_place_here(&arena, thread_id); // GT_ARENA=numa: once per mapping
+    }
 
     for (int round = 0; round < rounds; round++)
     {
         int partner = (thread_id + (1 << round)) % n_threads;
 
         // signal partner
-        flags[partner][parity * rounds + round] = !local_sense;
+        flags(partner)[parity * rounds + round] = local_sense;
 
         // spin on local sense until partner sends wake up call
-        while (flags[thread_id][parity * rounds + round] == local_sense);
+        gtspin_until(&flags(thread_id)[parity * rounds + round], local_sense, NULL, 1);
     }
 
     // flip local sense if parity is 1 after all rounds
@@ -125,85 +102,65 @@ void combined_barrier(){
         local_sense = !local_sense;
     }
     parity = 1 - parity; // alternate parity
-
-    #pragma omp master
-    {
-        gtmpi_barrier();
-    }
-
-
 }
 
-void combined_finalize(){ 
-    /*=============================================================
-    Tournament barrier
-    =============================================================*/
-    for(int i=0; i< P; i++)
-        free(tournament_rounds[i]);
-    free(tournament_rounds);
-
+void combined_barrier(){
     /*=============================================================
     Dissemination barrier
     =============================================================*/
-    for (int i = 0; i < n_threads; i++)
+    uint64_t span_begin = TRACE_BEGIN();
+    dissemination_barrier(omp_get_thread_num());
+    TRACE_END(span_intra, -1, span_begin);
+    episode++;
+
+    /*
+        The node has arrived, the other nodes may not have: the master
+        runs the tournament, then releases the other threads, which wait
+        on released (one shared word, written once per episode).
+    */
+    #pragma omp master
     {
-        free(flags[i]);
+        gtmpi_barrier();
+        __atomic_store_n(&released, episode, __ATOMIC_RELEASE);
     }
-    free(flags);
+    span_begin = TRACE_BEGIN();
+    gtspin_until((volatile int*)&released, episode, NULL, 1);
+    TRACE_END(span_release, -1, span_begin);
 }
 
-void gtmpi_barrier(){ // MPI_Barrier(MPI_COMM_WORLD);
-    int tournament_round = 1; // first tournament_round
-    int exit_arrival = 1;
+void combined_allreduce(double *values, int n, enum combined_op op){
+    int thread_id = omp_get_thread_num();
+    uint64_t span_begin = TRACE_BEGIN();
 
-    // arrival loop
-    while(exit_arrival){
-        switch(tournament_rounds[vpid][tournament_round].role)
-        {
-            case loser:
-                MPI_Send(                
-                    &sense, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD);
-                MPI_Recv( 
-                    &tournament_rounds[vpid][tournament_round].flag, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                exit_arrival = 0; //exit loop
-                break;
-            case winner:
-                MPI_Recv( 
-                    &tournament_rounds[vpid][tournament_round].flag, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                break; // no need exit_arrival because champion will do in the last round
-            case champion:
-                MPI_Recv( 
-                    &tournament_rounds[vpid][tournament_round].flag, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                MPI_Send(                
-                    &sense, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD);
-                exit_arrival = 0; // exit loop
-                break;
-            case bye: // do nothing
-            case dropout: // impossible
-                break;
-        }
-        if(exit_arrival)
-            tournament_round += 1; // move to next round
-    }
+    combined_payload_check(n);
+    // arrival: publish this thread's contribution
+    memcpy(payload(thread_id)->v, values, n * sizeof(double));
+    dissemination_barrier(thread_id);
+    TRACE_END(span_intra, -1, span_begin);
 
-    int exit_wakeup = 1;
-    while(exit_wakeup){
-        tournament_round -= 1;
-        switch(tournament_rounds[vpid][tournament_round].role)
+    #pragma omp master
+    {
+        // intra-node combine, then carry the node's partial through the tournament
+        memcpy(result, payload(0)->v, n * sizeof(double));
+        for (int i = 1; i < n_threads; i++)
         {
-            case winner:
-                MPI_Send(               
-                    &sense, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD);
-                break;
-            case dropout:
-                exit_wakeup = 0; // exit loop when all round is done
-                break;
-            case loser: // impossible
-            case bye: // do nothing
-            case champion: // impossible
-                break;
+            combine_payload(result, payload(i)->v, n, op);
         }
+        gtmpi_allreduce(result, n, op);
     }
 
-    sense = !sense; // reverse barrier
-}
\ No newline at end of file
+    // release: nobody reads the result before the master has written it
+    span_begin = TRACE_BEGIN();
+    dissemination_barrier(thread_id);
+    TRACE_END(span_release, -1, span_begin);
+    memcpy(values, result, n * sizeof(double));
+}
+
+void combined_finalize(){
+    /*=============================================================
+    Tournament barrier
+    =============================================================*/
+    tournament_finalize();
+
+    // the thread arena stays mapped for the next combined_init
+}
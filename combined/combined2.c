@@ -1,181 +1,119 @@
 #include <stdlib.h>
+#include <string.h>
 #include <mpi.h>
 #include <omp.h>
 #include <stdio.h>
 #include "combined.h"
+#include "combined_trace.h"
+#include "gtspin.h"
 
-/*=============================================================
-Tournament barrier
-=============================================================*/
-int P; // num_processes
-int vpid; // process id
-int num_tournament_rounds;
-tournament_round_t **tournament_rounds;
-bool sense;
+// only the master thread talks to MPI
+const int combined_thread_level = MPI_THREAD_FUNNELED;
 
 /*=============================================================
 Sense-reversing barrier
 =============================================================*/
-int s_P;
-int count;
-bool s_sense;
-static bool local_sense = true;
+static int s_P;
+static int count;
+static int s_sense;
+static int local_sense = 1;
 #pragma omp threadprivate(local_sense)
 
-void gtmpi_barrier();
+/*=============================================================
+Allreduce payload: combined under the arrival critical section
+=============================================================*/
+static double accum[COMBINED_MAX_PAYLOAD];
+static double result[COMBINED_MAX_PAYLOAD];
+
+// node release after the MPI phase: the master writes the new sense
+static int released;
+
 void combined_init(int num_processes, int num_threads){
     /*=============================================================
     Sense-reversing barrier
     =============================================================*/
     s_P = num_threads;
     count = s_P;
-    s_sense = true;
+    s_sense = 1;
+    released = 1;
+    gtspin_init();
 
     /*=============================================================
     Tournament barrier
     =============================================================*/
-    P = num_processes;
-    num_tournament_rounds = ceil(log2(P));
-    MPI_Comm_rank(MPI_COMM_WORLD, &vpid);
-    sense = true;
-
-    tournament_rounds = (tournament_round_t **)calloc(P, sizeof(tournament_round_t *));
-    for(int i=0; i< P; i++){
-        tournament_rounds[i] = (tournament_round_t *)calloc(num_tournament_rounds+1, sizeof(tournament_round_t));
-    }
-
-    for(int i=0; i<P; i++){
-        for(int k=0; k<num_tournament_rounds+1; k++){
-            // init flag to false;
-            tournament_rounds[i][k].flag = false;
-
-            // init role;
-            if(k > 0){ 
-                if(i % (int)pow(2,k) == 0){ // bye or winner
-                    if( (i + (int)pow(2,k-1) < P) && ((int)pow(2,k) < P)){ //  && not last round
-                        tournament_rounds[i][k].role = winner;
-                    } else if(i + (int)pow(2,k-1) >= P){ // not available in this round // !review again
-                        tournament_rounds[i][k].role = bye;
-                    }
-                } 
-
-                if(i % (int)pow(2,k) == (int)pow(2,k-1)){ // loser
-                    tournament_rounds[i][k].role = loser;
-                }
-                
-                if( (i == 0) && ((int)pow(2,k) >= P) ){ // champion when root proc && when last round
-                    tournament_rounds[i][k].role = champion;
-                }
-            }else if(k==0){ // dropout
-                tournament_rounds[i][k].role = dropout;
-            }
-
-            // init opponent;
-            switch(tournament_rounds[i][k].role)
-            {
-                case loser: // loser point to its winner
-                    tournament_rounds[i][k].opponent = i - (int)pow(2,k-1); // opponent to MPI_Send
-                    break;
-                case winner: // winner and champion point to its loser
-                case champion: 
-                    tournament_rounds[i][k].opponent = i + (int)pow(2,k-1);
-                    break;        
-                case dropout: // not needed
-                    tournament_rounds[i][k].opponent = -1;
-                    break;
-                case bye: // not needed
-                    tournament_rounds[i][k].opponent = -1;
-                    break;
-            }
-        }
-    }
+    tournament_init(num_processes);
 }
 
-void combined_barrier(){
-    /*=============================================================
-    Sense-reversing barrier
-    =============================================================*/
-    local_sense = !local_sense; // each processor toggles its own sense
+/*
+    Centralized arrival. When values is non-NULL each arriving thread
+    folds its payload into accum while it holds the counter, so the
+    node's partial is complete the moment the last thread arrives.
+*/
+static void central_barrier(const double *values, int n, enum combined_op op){
+    // the opposite of the current global sense: s_sense cannot flip before
+    // this thread arrives, and local_sense would go stale across re-inits
+    local_sense = !__atomic_load_n(&s_sense, __ATOMIC_ACQUIRE);
+    int left;
     #pragma omp critical // if fetch_and_decrement ($count) = 1
         {
-            count--;
+            if(values != NULL){
+                if(count == s_P)
+                    memcpy(accum, values, n * sizeof(double)); // first arrival
+                else
+                    combine_payload(accum, values, n, op);
+            }
+            left = --count;
             if(count == 0){
                 count = s_P;
                 s_sense = local_sense; // last processor toggles global sense
             }
         }
 
-    while(s_sense != local_sense);
+    gtspin_until(&s_sense, local_sense, &count, left);
+}
+
+void combined_barrier(){
+    /*=============================================================
+    Sense-reversing barrier
+    =============================================================*/
+    uint64_t span_begin = TRACE_BEGIN();
+    central_barrier(NULL, 0, combined_sum);
+    TRACE_END(span_intra, -1, span_begin);
 
+    // the other nodes may not have arrived yet: the master runs the
+    // tournament, then releases the node with this episode's sense
     #pragma omp master
     {
         gtmpi_barrier();
+        __atomic_store_n(&released, local_sense, __ATOMIC_RELEASE);
     }
+    span_begin = TRACE_BEGIN();
+    gtspin_until(&released, local_sense, NULL, 1);
+    TRACE_END(span_release, -1, span_begin);
+}
+
+void combined_allreduce(double *values, int n, enum combined_op op){
+    combined_payload_check(n);
+    uint64_t span_begin = TRACE_BEGIN();
+    central_barrier(values, n, op);
+    TRACE_END(span_intra, -1, span_begin);
 
+    #pragma omp master
+    {
+        memcpy(result, accum, n * sizeof(double));
+        gtmpi_allreduce(result, n, op);
+    }
 
+    // release: nobody reads the result before the master has written it
+    span_begin = TRACE_BEGIN();
+    central_barrier(NULL, 0, op);
+    TRACE_END(span_release, -1, span_begin);
+    memcpy(values, result, n * sizeof(double));
 }
 
-void combined_finalize(){ 
+void combined_finalize(){
     /*=============================================================
     Tournament barrier
     =============================================================*/
-    for(int i=0; i< P; i++)
-        free(tournament_rounds[i]);
-    free(tournament_rounds);
+    tournament_finalize();
 }
-
-void gtmpi_barrier(){ // MPI_Barrier(MPI_COMM_WORLD);
-    int tournament_round = 1; // first tournament_round
-    int exit_arrival = 1;
-
-    // arrival loop
-    while(exit_arrival){
-        switch(tournament_rounds[vpid][tournament_round].role)
-        {
-            case loser:
-                MPI_Send(                
-                    &sense, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD);
-                MPI_Recv( 
-                    &tournament_rounds[vpid][tournament_round].flag, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                exit_arrival = 0; //exit loop
-                break;
-            case winner:
-                MPI_Recv( 
-                    &tournament_rounds[vpid][tournament_round].flag, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                break; // no need exit_arrival because champion will do in the last round
-            case champion:
-                MPI_Recv( 
-                    &tournament_rounds[vpid][tournament_round].flag, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                MPI_Send(                
-                    &sense, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD);
-                exit_arrival = 0; // exit loop
-                break;
-            case bye: // do nothing
-            case dropout: // impossible
-                break;
-        }
-        if(exit_arrival)
-            tournament_round += 1; // move to next round
-    }
-
-    int exit_wakeup = 1;
-    while(exit_wakeup){
-        tournament_round -= 1;
-        switch(tournament_rounds[vpid][tournament_round].role)
-        {
-            case winner:
-                MPI_Send(               
-                    &sense, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD);
-                break;
-            case dropout:
-                exit_wakeup = 0; // exit loop when all round is done
-                break;
-            case loser: // impossible
-            case bye: // do nothing
-            case champion: // impossible
-                break;
-        }
-    }
-
-    sense = !sense; // reverse barrier
-}
\ No newline at end of file
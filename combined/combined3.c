@@ -1,22 +1,65 @@
 #include <stdlib.h>
+#include <string.h>
 #include <mpi.h>
 #include <omp.h>
 #include <stdio.h>
 #include "combined.h"
+#include "gtarena.h"
+
+// only the master thread talks to MPI
+const int combined_thread_level = MPI_THREAD_FUNNELED;
+
+typedef struct{
+    double v[COMBINED_MAX_PAYLOAD];
+} payload_t;
+
+static gtarena_t arena; // payload slots, a region per thread (GT_ARENA, see gtarena.h)
+static double result[COMBINED_MAX_PAYLOAD];
+static int n_threads;
+
+static inline payload_t *payload(int thread_id){
+    return (payload_t*)gtarena_region(&arena, thread_id);
+}
 
 void combined_init(int num_processes, int num_threads){
+    n_threads = num_threads;
+    gtarena_begin(&arena, n_threads, sizeof(payload_t), 0);
 }
 
 void combined_barrier(){
-    #pragma omp barrier 
+    #pragma omp barrier
     #pragma omp master
     {
         MPI_Barrier(MPI_COMM_WORLD);
     }
+    #pragma omp barrier // master has no implied barrier: hold the node until MPI is done
+}
 
+/*
+    Control for the fused collective: the separate thread reduction plus
+    MPI_Allreduce that the hybrid barriers replace.
+*/
+void combined_allreduce(double *values, int n, enum combined_op op){
+    MPI_Op mpi_op = op == combined_min ? MPI_MIN : op == combined_max ? MPI_MAX : MPI_SUM;
+    int thread_id = omp_get_thread_num();
 
+    combined_payload_check(n);
+    gtarena_place_here(&arena, thread_id); // GT_ARENA=numa: the first call moves the slot
+    memcpy(payload(thread_id)->v, values, n * sizeof(double));
+    #pragma omp barrier
+    #pragma omp master
+    {
+        memcpy(result, payload(0)->v, n * sizeof(double));
+        for (int i = 1; i < n_threads; i++)
+        {
+            combine_payload(result, payload(i)->v, n, op);
+        }
+        MPI_Allreduce(MPI_IN_PLACE, result, n, MPI_DOUBLE, mpi_op, MPI_COMM_WORLD);
+    }
+    #pragma omp barrier
+    memcpy(values, result, n * sizeof(double));
 }
 
-void combined_finalize(){ 
+void combined_finalize(){
 }
 
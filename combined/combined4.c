@@ -0,0 +1,162 @@
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+#include <omp.h>
+#include <stdio.h>
+#include "combined.h"
+#include "combined_trace.h"
+#include "gtarena.h"
+#include "gtspin.h"
+
+/*=============================================================
+Flat dissemination barrier (threads as endpoints)
+
+Every thread on every rank is a participant with virtual id
+    me = rank * T + thread_id
+and runs ceil(log2(P*T)) dissemination rounds over all P*T ids.
+In round k, me signals (me + 2^k) mod PT and waits for
+(me - 2^k) mod PT:
+    - partner on the same rank: shared-memory flag, as in gtmp1.c
+    - partner on another rank:  MPI message tagged with the
+      receiving thread and the round, so threads never steal
+      each other's messages
+
+There is no funnel through the master thread, so the MPI library
+must be initialized with MPI_THREAD_MULTIPLE.
+=============================================================*/
+const int combined_thread_level = MPI_THREAD_MULTIPLE;
+
+static int rounds;
+static int n_threads;
+static int rank;
+static int participants;
+static int generation;  // bumped by combined_init
+static int parity = 0;
+static int local_sense = 1;
+static int joined = 0;  // generation this thread's parity and sense belong to
+#pragma omp threadprivate(parity, local_sense, joined)
+
+/*=============================================================
+Allreduce payload (control path, see combined_allreduce)
+=============================================================*/
+typedef struct{
+    double v[COMBINED_MAX_PAYLOAD];
+} payload_t;
+
+static double result[COMBINED_MAX_PAYLOAD];
+
+/*=============================================================
+Thread state: one arena region per thread (GT_ARENA, see
+gtarena.h), its flags[parity][round] then its payload slot
+=============================================================*/
+static gtarena_t arena;
+static size_t flag_row; // bytes of flags in front of the payload
+
+static inline int *flags(int thread_id){
+    return (int*)gtarena_region(&arena, thread_id);
+}
+
+static inline payload_t *payload(int thread_id){
+    return (payload_t*)((char*)gtarena_region(&arena, thread_id) + flag_row);
+}
+
+void combined_init(int num_processes, int num_threads){
+    n_threads = num_threads;
+    participants = num_processes * num_threads;
+    rounds = (int)ceil(log2(participants));
+    generation++;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    // flags[thread_id][parity][round] and payload slots, all zeroed
+    flag_row = GTARENA_SIZE(2 * rounds * sizeof(int));
+    gtarena_begin(&arena, n_threads, flag_row + sizeof(payload_t), 0);
+    gtspin_init();
+}
+
+static void flat_barrier(int thread_id){
+    int me = rank * n_threads + thread_id;
+
+    // first episode on freshly zeroed flags: parity and sense outlive
+    // combined_finalize, so they restart here
+    if (joined != generation)
+    {
+        joined = generation;
+        parity = 0;
+        local_sense = 1;
+        gtarena_place_here(&arena, thread_id); // GT_ARENA=numa: once per mapping
+    }
+
+    for (int round = 0; round < rounds; round++)
+    {
+        int distance = 1 << round;
+        int to = (me + distance) % participants;
+        int from = (me - distance + participants) % participants;
+        MPI_Request request = MPI_REQUEST_NULL;
+        int token;
+        uint64_t span_begin = TRACE_BEGIN();
+
+        // signal partner
+        if (to / n_threads == rank)
+        {
+            flags(to % n_threads)[parity * rounds + round] = local_sense;
+        }
+        else
+        {
+            MPI_Isend(&local_sense, 1, MPI_INT, to / n_threads,
+                (to % n_threads) * rounds + round, MPI_COMM_WORLD, &request);
+        }
+
+        // wait for the wake up call from the partner behind us
+        if (from / n_threads == rank)
+        {
+            gtspin_until(&flags(thread_id)[parity * rounds + round], local_sense, NULL, 1);
+        }
+        else
+        {
+            MPI_Recv(&token, 1, MPI_INT, from / n_threads,
+                thread_id * rounds + round, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        }
+
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+        TRACE_END(span_round, round, span_begin);
+    }
+
+    if (parity == 1)
+    {
+        local_sense = !local_sense;
+    }
+    parity = 1 - parity; // alternate parity
+}
+
+void combined_barrier(){
+    flat_barrier(omp_get_thread_num());
+}
+
+/*
+    The flat schedule has no single owner of a node's partial, so the
+    reduction falls back to the control path: thread slots, one MPI_Allreduce
+    from the master, and omp barriers around it.
+*/
+void combined_allreduce(double *values, int n, enum combined_op op){
+    MPI_Op mpi_op = op == combined_min ? MPI_MIN : op == combined_max ? MPI_MAX : MPI_SUM;
+    int thread_id = omp_get_thread_num();
+
+    combined_payload_check(n);
+    memcpy(payload(thread_id)->v, values, n * sizeof(double));
+    #pragma omp barrier
+    #pragma omp master
+    {
+        memcpy(result, payload(0)->v, n * sizeof(double));
+        for (int i = 1; i < n_threads; i++)
+        {
+            combine_payload(result, payload(i)->v, n, op);
+        }
+        MPI_Allreduce(MPI_IN_PLACE, result, n, MPI_DOUBLE, mpi_op, MPI_COMM_WORLD);
+    }
+    #pragma omp barrier
+    memcpy(values, result, n * sizeof(double));
+}
+
+void combined_finalize(){
+    // the thread arena stays mapped for the next combined_init
+}
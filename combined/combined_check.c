@@ -0,0 +1,234 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <mpi.h>
+#include <omp.h>
+#include "combined.h"
+#include "gtcheck.h"
+#include "gtspin.h"
+#include "gtstats.h"
+
+/*
+  Stress and regression check for one combined barrier (combined1_check ..
+  combined4_check, run by make check). See gtcheck.h.
+
+  Launched on N ranks, the stress part runs teams of N x 1 .. N x T
+  threads (T = 64 / N by default), and the regression part teams of N x
+  (team / N) threads; make check launches once on 1 rank for the stress
+  part alone and once on CHECK_RANKS for both. The per-episode arrival counters live in an RMA
+  window on rank 0 that every thread of every rank adds to, so the check
+  needs MPI_THREAD_MULTIPLE whatever the barrier itself needs. Oversubscribed
+  teams wait with sched_yield, as in the omp check.
+
+  Usage: mpirun -np N ./combinedN_check [-p max_threads] [-e episodes] [-w workload]
+                                        [-t teams] [-n episodes] [-b baseline] [-s slack] [-r]
+      -p -e -w    stress: up to max_threads per rank (default 64 / N), episodes
+                  each (default 200, 0 skips it), delays from workload
+                  (default pareto:2000:1.5)
+      -t -n       regression: median over n episodes (default 1000) per run
+                  on each team of the list, in threads over all ranks (default 4,8;
+                  each a multiple of N)
+      -b -s       baseline file (default check.baseline.<host>), slack (1.5,
+                  0 skips the regression)
+      -r          only measure, and print the baseline lines
+*/
+// returns the early departures this rank saw, *first (episodes on entry) the first such episode
+static int stress(int num_processes, int my_id, int T, int episodes, const gtwork_t *work, int *first){
+  int *counters, early = 0;
+  int P = num_processes * T;
+  MPI_Win win;
+
+  MPI_Win_allocate(my_id == 0 ? episodes * sizeof(int) : 0, sizeof(int), MPI_INFO_NULL, MPI_COMM_WORLD, &counters, &win);
+  if(my_id == 0)
+    memset(counters, 0, episodes * sizeof(int));
+  MPI_Barrier(MPI_COMM_WORLD); // counters zeroed before the first arrival
+  MPI_Win_lock_all(0, win);
+
+  combined_init(num_processes, T);
+  #pragma omp parallel num_threads(T) reduction(+:early)
+  {
+    int me = my_id * T + omp_get_thread_num(), one = 1, arrived;
+    for(int e = 0; e < episodes; e++){
+      gtcheck_delay(work, me, P, e);
+      MPI_Fetch_and_op(&one, &arrived, MPI_INT, 0, e, MPI_SUM, win);
+      MPI_Win_flush(0, win); // the arrival is at rank 0 before this thread enters
+      combined_barrier();
+      MPI_Fetch_and_op(NULL, &arrived, MPI_INT, 0, e, MPI_NO_OP, win);
+      MPI_Win_flush(0, win);
+      if(arrived != P){
+        #pragma omp critical
+        {
+          if(e < *first)
+            *first = e;
+        }
+        early++;
+      }
+    }
+  }
+  combined_finalize();
+
+  MPI_Win_unlock_all(win);
+  MPI_Win_free(&win);
+  return early;
+}
+
+// median episode latency over every thread of every rank, on rank 0
+static double median_latency(int num_processes, int T, int episodes){
+  gtstats_hist_t *hists = (gtstats_hist_t*)malloc(T * sizeof(gtstats_hist_t));
+  gtstats_hist_t local, all;
+
+  combined_init(num_processes, T);
+  #pragma omp parallel num_threads(T)
+  {
+    int me = omp_get_thread_num();
+    gtstats_hist_init(&hists[me]);
+    for(int e = 0; e < episodes / 10; e++) // warm-up
+      combined_barrier();
+    for(int e = 0; e < episodes; e++){
+      uint64_t arrive = gtstats_now();
+      combined_barrier();
+      gtstats_hist_record(&hists[me], gtstats_now() - arrive);
+    }
+  }
+  combined_finalize();
+
+  gtstats_hist_init(&local);
+  gtstats_hist_init(&all);
+  for(int t = 0; t < T; t++)
+    gtstats_hist_merge(&local, &hists[t]);
+  free(hists);
+  MPI_Reduce(local.buckets, all.buckets, GTSTATS_BUCKETS, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local.count, &all.count, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local.min, &all.min, 1, MPI_UINT64_T, MPI_MIN, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local.max, &all.max, 1, MPI_UINT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
+  return gtstats_hist_percentile(&all, 50);
+}
+
+static void fail(int my_id, const char *name, const char *message){
+  if(my_id == 0)
+    fprintf(stderr, "%s: %s\n", name, message);
+  MPI_Finalize();
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+  const char *name = gtcheck_basename(argv[0]);
+  char default_baseline[512];
+  const char *baseline = default_baseline, *spec = GTCHECK_WORK;
+  const char *team_list = GTCHECK_TEAMS;
+  int max_threads = 0, episodes = 200, perf_episodes = 1000, record = 0, opt;
+  int num_processes, my_id, provided, teams[GTCHECK_TEAMS_MAX], n_teams;
+  double slack = GTCHECK_SLACK;
+  gtwork_t work;
+
+  gtcheck_baseline_path(default_baseline, sizeof(default_baseline));
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+  MPI_Comm_size(MPI_COMM_WORLD, &num_processes);
+  MPI_Comm_rank(MPI_COMM_WORLD, &my_id);
+  if(provided < MPI_THREAD_MULTIPLE)
+    fail(my_id, name, "the arrival counters need MPI_THREAD_MULTIPLE");
+
+  while((opt = getopt(argc, argv, "p:e:w:t:n:b:s:r")) != -1){
+    switch(opt){
+      case 'p': max_threads = strtol(optarg, NULL, 10); break;
+      case 'e': episodes = strtol(optarg, NULL, 10); break;
+      case 'w': spec = optarg; break;
+      case 't': team_list = optarg; break;
+      case 'n': perf_episodes = strtol(optarg, NULL, 10); break;
+      case 'b': baseline = optarg; break;
+      case 's': slack = strtod(optarg, NULL); break;
+      case 'r': record = 1; break;
+      default:
+        fail(my_id, name, "usage: [-p max_threads] [-e episodes] [-w workload] [-t teams] [-n episodes] [-b baseline] [-s slack] [-r]");
+    }
+  }
+  if(max_threads == 0)
+    max_threads = 64 / num_processes > 0 ? 64 / num_processes : 1;
+  n_teams = gtcheck_teams(team_list, teams);
+  if(max_threads < 1 || episodes < 0 || n_teams == 0 || perf_episodes < 10 || slack < 0 || !gtwork_parse(&work, spec))
+    fail(my_id, name, "bad -p, -e, -t, -n, -s or -w");
+  for(int i = 0; (record || slack > 0) && i < n_teams; i++){
+    if(teams[i] % num_processes != 0)
+      fail(my_id, name, "a -t team does not split evenly over the ranks; run with other ranks or -s 0");
+  }
+
+  // ranks sharing this node split its CPUs
+  MPI_Comm node;
+  int node_size, cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, my_id, MPI_INFO_NULL, &node);
+  MPI_Comm_size(node, &node_size);
+  MPI_Comm_free(&node);
+
+  omp_set_dynamic(0);
+  gtspin_init();
+  enum gtspin_policy policy = gtspin_policy;
+  char team[GTCHECK_TEAM_MAX], what[128];
+  int failed = 0;
+
+  if(!record && episodes > 0){
+    int early_total = 0, first_T = 0;
+    struct{ int episode; int rank; } first_local, first = { 0, 0 };
+
+    for(int T = 1; T <= max_threads; T++){
+      int early, episode = episodes, sum;
+
+      snprintf(what, sizeof(what), "%s: stress on %d x %d threads (rank %d)", name, num_processes, T, my_id);
+      gtcheck_watchdog(what, GTCHECK_TIMEOUT);
+      gtspin_policy = node_size * T > cpus ? gtspin_yield : policy;
+      early = stress(num_processes, my_id, T, episodes, &work, &episode);
+
+      // the first team with early departures, and its earliest one
+      first_local.episode = early > 0 ? episode : episodes;
+      first_local.rank = my_id;
+      MPI_Allreduce(&early, &sum, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+      if(sum > 0 && early_total == 0){
+        MPI_Allreduce(&first_local, &first, 1, MPI_2INT, MPI_MINLOC, MPI_COMM_WORLD);
+        first_T = T;
+      }
+      early_total += sum;
+    }
+    gtcheck_watchdog(NULL, 0);
+    gtspin_policy = policy;
+
+    if(my_id == 0){
+      if(early_total > 0){
+        printf("%s: stress %d x 1-%d threads x %d episodes (%s): FAILED, %d early departures;"
+               " first on %d x %d threads, episode %d: a thread of rank %d left before everybody arrived\n",
+          name, num_processes, max_threads, episodes, work.spec, early_total, num_processes, first_T, first.episode, first.rank);
+        failed = 1;
+      }
+      else
+        printf("%s: stress %d x 1-%d threads x %d episodes (%s): ok\n", name, num_processes, max_threads, episodes, work.spec);
+    }
+  }
+
+  for(int i = 0; (record || slack > 0) && i < n_teams; i++){
+    int T = teams[i] / num_processes;
+
+    snprintf(what, sizeof(what), "%s: regression on %d x %d threads (rank %d)", name, num_processes, T, my_id);
+    gtcheck_watchdog(what, GTCHECK_TIMEOUT);
+    gtspin_policy = node_size * T > cpus ? gtspin_yield : policy;
+    double median = median_latency(num_processes, T, perf_episodes);
+    for(int r = 1; r < GTCHECK_REPEATS; r++){
+      double again = median_latency(num_processes, T, perf_episodes);
+      if(again < median)
+        median = again;
+    }
+    gtcheck_watchdog(NULL, 0);
+    gtspin_policy = policy;
+    snprintf(team, sizeof(team), "%dx%d", num_processes, T);
+
+    if(my_id == 0){
+      if(record)
+        gtcheck_record(stdout, name, team, median);
+      else
+        failed |= gtcheck_regression(stdout, baseline, name, team, median, slack);
+    }
+  }
+
+  MPI_Bcast(&failed, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Finalize();
+  return failed;
+}
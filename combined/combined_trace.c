@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+#include <omp.h>
+#include "combined_trace.h"
+#include "gtstats.h"
+
+#define OFFSET_PINGS 16
+#define OFFSET_TAG 7
+
+typedef struct{
+    uint64_t begin; // aligned to rank 0's clock
+    uint64_t end;
+    int32_t span;
+    int32_t round;
+    int32_t thread;
+    int32_t pad;
+} span_t;
+
+typedef struct{
+    span_t *spans;
+    int count;
+} __attribute__((aligned(64))) span_buffer_t;
+
+int combined_trace_on;
+
+static span_buffer_t *buffers;
+static int n_threads;
+static int64_t offset; // rank 0 clock - local clock
+
+static const char *span_names[] = {
+    "work", "intra-node", "tournament send", "tournament recv", "release", "round"
+};
+
+/*
+    Cristian's algorithm against rank 0: keep the ping with the shortest
+    round trip and assume the reply was stamped half way through it.
+*/
+static void estimate_offset(){
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    offset = 0;
+    for (int peer = 1; peer < size; peer++)
+    {
+        if (rank == 0)
+        {
+            for (int k = 0; k < OFFSET_PINGS; k++)
+            {
+                uint64_t now;
+                MPI_Recv(&now, 1, MPI_UINT64_T, peer, OFFSET_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                now = gtstats_now();
+                MPI_Send(&now, 1, MPI_UINT64_T, peer, OFFSET_TAG, MPI_COMM_WORLD);
+            }
+        }
+        else if (rank == peer)
+        {
+            uint64_t best_rtt = UINT64_MAX;
+            for (int k = 0; k < OFFSET_PINGS; k++)
+            {
+                uint64_t remote, sent = gtstats_now();
+                MPI_Send(&sent, 1, MPI_UINT64_T, 0, OFFSET_TAG, MPI_COMM_WORLD);
+                MPI_Recv(&remote, 1, MPI_UINT64_T, 0, OFFSET_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                uint64_t received = gtstats_now();
+                if (received - sent < best_rtt)
+                {
+                    best_rtt = received - sent;
+                    offset = (int64_t)remote - (int64_t)(sent + best_rtt / 2);
+                }
+            }
+        }
+    }
+}
+
+void combined_trace_init(int num_threads){
+    n_threads = num_threads;
+    buffers = (span_buffer_t*)calloc(n_threads, sizeof(span_buffer_t));
+    for (int t = 0; t < n_threads; t++)
+    {
+        buffers[t].spans = (span_t*)malloc(COMBINED_TRACE_CAPACITY * sizeof(span_t));
+    }
+    estimate_offset();
+}
+
+void combined_trace_enable(int on){
+    combined_trace_on = on;
+}
+
+uint64_t combined_trace_now(){
+    return gtstats_now() + offset;
+}
+
+void combined_trace_record(enum combined_span span, int round, uint64_t begin){
+    int thread_id = omp_get_thread_num();
+    span_buffer_t *buffer = &buffers[thread_id];
+
+    if (buffer->count == COMBINED_TRACE_CAPACITY)
+        return;
+
+    span_t *s = &buffer->spans[buffer->count++];
+    s->begin = begin;
+    s->end = combined_trace_now();
+    s->span = span;
+    s->round = round;
+    s->thread = thread_id;
+}
+
+void combined_trace_write(const char *path){
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // pack this rank's threads into one array
+    int local = 0;
+    for (int t = 0; t < n_threads; t++)
+    {
+        local += buffers[t].count;
+    }
+    span_t *packed = (span_t*)malloc((local > 0 ? local : 1) * sizeof(span_t));
+    int at = 0;
+    for (int t = 0; t < n_threads; t++)
+    {
+        memcpy(&packed[at], buffers[t].spans, buffers[t].count * sizeof(span_t));
+        at += buffers[t].count;
+    }
+
+    int bytes = local * sizeof(span_t);
+    int *counts = NULL, *displs = NULL;
+    span_t *all = NULL;
+    if (rank == 0)
+    {
+        counts = (int*)malloc(size * sizeof(int));
+        displs = (int*)malloc(size * sizeof(int));
+    }
+    MPI_Gather(&bytes, 1, MPI_INT, counts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    int total = 0;
+    if (rank == 0)
+    {
+        for (int r = 0; r < size; r++)
+        {
+            displs[r] = total;
+            total += counts[r];
+        }
+        all = (span_t*)malloc(total > 0 ? total : 1);
+    }
+    MPI_Gatherv(packed, bytes, MPI_BYTE, all, counts, displs, MPI_BYTE, 0, MPI_COMM_WORLD);
+
+    if (rank == 0)
+    {
+        FILE *out = fopen(path, "w");
+        if (out == NULL)
+        {
+            perror(path);
+        }
+        else
+        {
+            // timestamps relative to the earliest span, in microseconds
+            uint64_t origin = UINT64_MAX;
+            for (int r = 0; r < size; r++)
+            {
+                span_t *spans = (span_t*)((char*)all + displs[r]);
+                for (int k = 0; k < counts[r] / (int)sizeof(span_t); k++)
+                {
+                    if (spans[k].begin < origin)
+                        origin = spans[k].begin;
+                }
+            }
+
+            fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+            int first = 1;
+            for (int r = 0; r < size; r++)
+            {
+                fprintf(out, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"rank %d\"}}",
+                    first ? "" : ",\n", r, r);
+                first = 0;
+
+                span_t *spans = (span_t*)((char*)all + displs[r]);
+                for (int k = 0; k < counts[r] / (int)sizeof(span_t); k++)
+                {
+                    fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"barrier\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"round\":%d}}",
+                        span_names[spans[k].span], r, spans[k].thread,
+                        (spans[k].begin - origin) / 1e3, (spans[k].end - spans[k].begin) / 1e3, spans[k].round);
+                }
+            }
+            fprintf(out, "\n]}\n");
+            fclose(out);
+        }
+        free(counts);
+        free(displs);
+        free(all);
+    }
+
+    free(packed);
+    for (int t = 0; t < n_threads; t++)
+    {
+        free(buffers[t].spans);
+    }
+    free(buffers);
+}
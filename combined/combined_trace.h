@@ -0,0 +1,43 @@
+#include <stdint.h>
+
+#ifndef COMBINED_TRACE_H
+#define COMBINED_TRACE_H
+
+/*
+    Chrome trace-event / Perfetto timeline of the hybrid barriers.
+
+    The harness enables it with GT_CHROME_TRACE=<path>. Every (rank, thread)
+    gets its own track (pid = rank, tid = thread) with complete ("X") spans
+    for user work, the intra-node phase, each tournament round's send and
+    recv, and the release. Timestamps are CLOCK_MONOTONIC_RAW shifted by a
+    per-rank offset to rank 0, estimated at startup from the ping with the
+    smallest round trip. Spans go into preallocated per-thread buffers;
+    combined_trace_write() gathers them on rank 0, which writes the JSON.
+*/
+#define COMBINED_TRACE_CAPACITY (1 << 16) // spans per thread, extra spans are dropped
+
+enum combined_span{
+    span_work = 0,
+    span_intra = 1,     // intra-node barrier (arrival)
+    span_send = 2,      // tournament arrival send
+    span_recv = 3,      // tournament arrival recv
+    span_release = 4,   // tournament wakeup / intra-node release
+    span_round = 5      // flat dissemination round (combined4)
+};
+
+extern int combined_trace_on;
+
+// collective: every rank must call these
+void combined_trace_init(int num_threads);
+void combined_trace_write(const char *path);
+
+void combined_trace_enable(int on);
+void combined_trace_record(enum combined_span span, int round, uint64_t begin);
+uint64_t combined_trace_now();
+
+// hooks cost one load and a branch while tracing is off
+#define TRACE_BEGIN() (combined_trace_on ? combined_trace_now() : 0)
+#define TRACE_END(span, round, begin) \
+    do { if (combined_trace_on) combined_trace_record((span), (round), (begin)); } while (0)
+
+#endif
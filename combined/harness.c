@@ -6,11 +6,34 @@
 #include <time.h>
 #include <string.h>
 #include "combined.h"
+#include "combined_trace.h"
+#include "gtstats.h"
+#include "gtperf.h"
+#include "gtwork.h"
+
+// merge every rank's histogram into rank 0's
+static void reduce_latency(gtstats_hist_t *local, gtstats_hist_t *global){
+  gtstats_hist_init(global);
+  MPI_Reduce(local->buckets, global->buckets, GTSTATS_BUCKETS, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local->count, &global->count, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local->sum, &global->sum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local->min, &global->min, 1, MPI_UINT64_T, MPI_MIN, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local->max, &global->max, 1, MPI_UINT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
+}
+
+// combine every rank's FTQ pass on rank 0 (every rank runs the same number of quanta)
+static void reduce_ftq(gtwork_ftq_t *local, gtwork_ftq_t *global, int num_processes){
+  MPI_Reduce(&local->samples, &global->samples, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local->mean, &global->mean, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local->min, &global->min, 1, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local->max, &global->max, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+  global->mean /= num_processes;
+}
 
 int main(int argc, char** argv)
 {
   double time_diff_sum;
-  struct timespec tstart, tend;
+  uint64_t tstart, tend;
   double dt;
 
   int num_processes, my_id;
@@ -20,12 +43,19 @@ int main(int argc, char** argv)
   int exp_iter = 1000;
   double total_time = 0;
   int pub = 0;
+  int allreduce = 0;
+  int mismatches = 0;
     
   // debugging purpose
   char processor_name[MPI_MAX_PROCESSOR_NAME];
   int name_len;
+  int provided;
 
-  MPI_Init(&argc, &argv);
+  MPI_Init_thread(&argc, &argv, combined_thread_level, &provided);
+  if(provided < combined_thread_level){
+    fprintf(stderr, "MPI library provides thread level %d, barrier needs %d\n", provided, combined_thread_level);
+    MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+  }
   
   if (argc < 2){
     fprintf(stderr, "Usage: ./harness [NUM_THREADS]\n");
@@ -42,37 +72,100 @@ int main(int argc, char** argv)
     printf("Warning: dynamic adjustment of threads has been set\n");
 
   omp_set_num_threads(num_threads);
+
+  // GT_ALLREDUCE=1: reduce thread_num across every thread on every node
+  // through combined_allreduce() instead of a bare combined_barrier()
+  if(getenv("GT_ALLREDUCE") != NULL)
+    allreduce = strtol(getenv("GT_ALLREDUCE"), NULL, 10);
+
   MPI_Comm_size(MPI_COMM_WORLD, &num_processes);
   MPI_Comm_rank(MPI_COMM_WORLD, &my_id);
   MPI_Get_processor_name(processor_name, &name_len); // Get the name of the processor
 
+  // GT_WORK=<spec>: synthetic compute before every barrier (gtwork.h), one
+  // draw per thread across all nodes
+  gtwork_t work;
+  int has_work = gtwork_from_env(&work);
+
+  // GT_FTQ=<quantum_ns>: OS noise on every thread of every node before the experiments
+  uint64_t quantum = getenv("GT_FTQ") != NULL ? strtoull(getenv("GT_FTQ"), NULL, 10) : 0;
+  gtwork_ftq_t noise = {0}, global_noise;
+  if(quantum > 0){
+    #pragma omp parallel shared(noise)
+    {
+      gtwork_ftq_t mine;
+      gtwork_ftq(quantum, GTWORK_FTQ_SAMPLES, &mine);
+      #pragma omp critical
+      gtwork_ftq_merge(&noise, &mine);
+    }
+    reduce_ftq(&noise, &global_noise, num_processes);
+  }
+
+  // GT_CHROME_TRACE=<path>: timeline of the last experiment as Chrome trace JSON
+  char *chrome_trace = getenv("GT_CHROME_TRACE");
+  if(chrome_trace != NULL)
+    combined_trace_init(num_threads);
+
+  // per-thread episode latencies, preallocated so the barrier loop never allocates
+  uint64_t **episodes = (uint64_t**)malloc(num_threads * sizeof(uint64_t*));
+  for(int t = 0; t < num_threads; t++)
+    episodes[t] = (uint64_t*)malloc(num_iter * sizeof(uint64_t));
+  gtstats_hist_t latency, global_latency;
+  gtstats_hist_init(&latency);
+
   for(int j=0; j< exp_iter; j++){
     combined_init(num_processes, num_threads);
-    clock_gettime(CLOCK_REALTIME, &tstart);
+    combined_trace_enable(chrome_trace != NULL && j == exp_iter - 1);
+    tstart = gtstats_now();
 
 
     /* ==============================================
     Parellel part
     ==============================================*/
     int i = 0;
-    #pragma omp parallel shared(pub) firstprivate(thread_num, i)
+    #pragma omp parallel shared(pub, mismatches) firstprivate(thread_num, i)
     {
       thread_num = omp_get_thread_num(); 
       for(i=0; i < num_iter; i++){
+        uint64_t arrive;
+        if(allreduce){
+          double residual = thread_num;
+          if(has_work)
+            gtwork_run(&work, my_id * num_threads + thread_num, num_processes * num_threads, (uint64_t)j * num_iter + i);
+          arrive = gtstats_now();
+          combined_allreduce(&residual, 1, combined_sum);
+          episodes[thread_num][i] = gtstats_now() - arrive;
+          if(residual != (double)num_processes * num_threads * (num_threads - 1) / 2){
+            #pragma omp atomic
+            mismatches++;
+          }
+          continue;
+        }
+
+        uint64_t span_begin = TRACE_BEGIN();
         #pragma omp critical 
         {
           pub += thread_num;
         }  
+        if(has_work)
+          gtwork_run(&work, my_id * num_threads + thread_num, num_processes * num_threads, (uint64_t)j * num_iter + i);
+        TRACE_END(span_work, i, span_begin);
 
+        arrive = gtstats_now();
         combined_barrier();
+        episodes[thread_num][i] = gtstats_now() - arrive;
       }
     }
 
     /* ==============================================
     Timing check & clean up
     ==============================================*/
-    clock_gettime(CLOCK_REALTIME, &tend);
-    dt = (tend.tv_sec*1e6+tend.tv_nsec/1e3)-(tstart.tv_sec*1e6+tstart.tv_nsec/1e3);
+    tend = gtstats_now();
+    dt = (tend - tstart) / 1e3;
+
+    for(int t = 0; t < num_threads; t++)
+      for(int k = 0; k < num_iter; k++)
+        gtstats_hist_record(&latency, episodes[t][k]);
 
     // Gather time calcaulation from all processes
     // Reference: https://rookiehpc.org/mpi/docs/mpi_sum/index.html
@@ -85,11 +178,63 @@ int main(int argc, char** argv)
     combined_finalize();  
   }
 
+  if(allreduce && mismatches > 0)
+    fprintf(stderr, "rank %d: %d allreduce results did not match\n", my_id, mismatches);
+
+  combined_trace_enable(0);
+  if(chrome_trace != NULL)
+    combined_trace_write(chrome_trace);
+
+  reduce_latency(&latency, &global_latency);
+  for(int t = 0; t < num_threads; t++)
+    free(episodes[t]);
+  free(episodes);
+
+  // GT_PERF=1: one extra, untimed pass with per-thread hardware counters
+  int profile = getenv("GT_PERF") != NULL;
+  int perf_iter = num_iter * 100;
+  gtperf_counts_t counts, global_counts;
+  if(profile){
+    gtperf_counts_init(&counts);
+    gtperf_counts_init(&global_counts);
+
+    combined_init(num_processes, num_threads);
+    #pragma omp parallel shared(counts) firstprivate(thread_num)
+    {
+      gtperf_t perf;
+      gtperf_counts_t mine;
+      gtperf_counts_init(&mine);
+      thread_num = omp_get_thread_num();
+
+      gtperf_open(&perf);
+      combined_barrier(); // every thread has its counters before any starts
+      gtperf_start(&perf);
+      for(int k = 0; k < perf_iter; k++) // barriers only: a critical section here would be counted too
+        combined_barrier();
+      gtperf_stop(&perf, &mine);
+      gtperf_close(&perf);
+
+      #pragma omp critical
+      gtperf_counts_merge(&counts, &mine);
+    }
+    combined_finalize();
+
+    MPI_Reduce(counts.value, global_counts.value, GTPERF_EVENTS, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(counts.valid, global_counts.valid, GTPERF_EVENTS, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+  }
+
   if(my_id == 0){
     printf("process:%d&thread:%d | Total time taken for %d: %f μs\n",num_processes, num_threads, exp_iter, total_time/num_processes);
 
     printf("Average time taken for %d : %f μs\n", exp_iter, total_time/num_processes/exp_iter);
     fprintf(stderr, "%d, %d, %f\n", num_processes, num_threads, total_time/num_processes/exp_iter);
+    if(quantum > 0)
+      gtwork_ftq_report(stdout, "OS noise", quantum, &global_noise);
+    if(has_work)
+      printf("Workload: %s\n", work.spec);
+    gtstats_hist_report(stdout, "Barrier episode latency", &global_latency, getenv("GT_HIST") != NULL);
+    if(profile)
+      gtperf_report(stdout, "Barrier counters", &global_counts, perf_iter);
   }
 
   MPI_Finalize();
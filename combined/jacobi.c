@@ -0,0 +1,154 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <mpi.h>
+#include <omp.h>
+#include "combined.h"
+#include "gtjacobi.h"
+#include "gtstats.h"
+
+/*
+    Bulk-synchronous Jacobi mini-app (combined_jacobi). The grid's planes
+    are split into one slab per rank, and each slab's planes among the
+    rank's threads. Every iteration:
+        halo        the master thread exchanges the edge planes with both
+                    neighbouring ranks (MPI_Sendrecv), then relaxes the two
+                    edge planes; the other threads relax the interior
+                    meanwhile, which never reads a halo
+        barrier     combined_allreduce of the partial residuals: the
+                    superstep barrier and the residual check in one call
+    Only the master thread calls MPI, so every combined barrier's thread
+    level is enough.
+
+    It links against any combined barrier, like the harness; combined1
+    by default.
+
+    Usage: mpirun -np N ./combined_jacobi [-t threads] [-g grid] [-i iterations] [-e tolerance]
+    Defaults: every online CPU, 1024x1024, 1000 iterations, tolerance 0
+    (run every iteration).
+*/
+typedef struct{
+  double value;
+  char pad[56];
+} padded_t;
+
+int main(int argc, char **argv)
+{
+  gtjacobi_grid_t grid;
+  char *spec = "1024x1024";
+  int num_threads = sysconf(_SC_NPROCESSORS_ONLN), iterations = 1000, opt;
+  int num_processes, my_id, provided;
+  double tolerance = 0;
+
+  MPI_Init_thread(&argc, &argv, combined_thread_level, &provided);
+  if(provided < combined_thread_level){
+    fprintf(stderr, "MPI library provides thread level %d, barrier needs %d\n", provided, combined_thread_level);
+    MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+  }
+  MPI_Comm_size(MPI_COMM_WORLD, &num_processes);
+  MPI_Comm_rank(MPI_COMM_WORLD, &my_id);
+
+  while((opt = getopt(argc, argv, "t:g:i:e:")) != -1){
+    switch(opt){
+      case 't': num_threads = strtol(optarg, NULL, 10); break;
+      case 'g': spec = optarg; break;
+      case 'i': iterations = strtol(optarg, NULL, 10); break;
+      case 'e': tolerance = strtod(optarg, NULL); break;
+      default:
+        if(my_id == 0)
+          fprintf(stderr, "Usage: %s [-t threads] [-g NXxNY[xNZ]] [-i iterations] [-e tolerance]\n", argv[0]);
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+  }
+  if(!gtjacobi_parse(&grid, spec) || num_threads < 1 || iterations < 1 || grid.planes < num_processes){
+    if(my_id == 0)
+      fprintf(stderr, "combined_jacobi: bad -t, -g or -i (the grid needs a plane per rank)\n");
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+
+  int first, last;
+  gtjacobi_split(grid.planes, num_processes, my_id, &first, &last);
+  int n = last - first + 1;
+  int up = my_id > 0 ? my_id - 1 : MPI_PROC_NULL;
+  int down = my_id < num_processes - 1 ? my_id + 1 : MPI_PROC_NULL;
+
+  double *a = gtjacobi_alloc(&grid, n, my_id == 0);
+  double *b = gtjacobi_alloc(&grid, n, my_id == 0);
+  padded_t *sync_ns = (padded_t*)calloc(num_threads, sizeof(padded_t));
+  if(a == NULL || b == NULL || sync_ns == NULL){
+    fprintf(stderr, "combined_jacobi: rank %d out of memory\n", my_id);
+    MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+  }
+
+  omp_set_dynamic(0);
+  omp_set_num_threads(num_threads);
+  combined_init(num_processes, num_threads);
+
+  int done = 0;
+  double residual = 0, halo_ns = 0;
+  uint64_t start = gtstats_now();
+
+  #pragma omp parallel shared(done, residual, halo_ns)
+  {
+    int me = omp_get_thread_num(), lo, hi, k;
+    double *old = a, *new = b, *swap, sum = 0;
+
+    // interior planes 2..n-1 in blocks; the master also owns planes 1 and n
+    gtjacobi_split(n > 2 ? n - 2 : 0, num_threads, me, &lo, &hi);
+    for(k = 0; k < iterations; k++){
+      sum = gtjacobi_sweep(&grid, old, new, lo + 1, hi + 1);
+      if(me == 0){
+        uint64_t t = gtstats_now();
+        MPI_Sendrecv(old + grid.plane, grid.plane, MPI_DOUBLE, up, 0,
+                     old + (n + 1) * grid.plane, grid.plane, MPI_DOUBLE, down, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        MPI_Sendrecv(old + n * grid.plane, grid.plane, MPI_DOUBLE, down, 1,
+                     old, grid.plane, MPI_DOUBLE, up, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        halo_ns += gtstats_now() - t;
+
+        sum += gtjacobi_sweep(&grid, old, new, 1, 1);
+        if(n > 1)
+          sum += gtjacobi_sweep(&grid, old, new, n, n);
+      }
+
+      uint64_t arrive = gtstats_now();
+      combined_allreduce(&sum, 1, combined_sum);
+      sync_ns[me].value += gtstats_now() - arrive;
+
+      swap = old;
+      old = new;
+      new = swap;
+      if(sqrt(sum) < tolerance){
+        k++;
+        break;
+      }
+    }
+    if(me == 0){
+      done = k;
+      residual = sqrt(sum);
+    }
+  }
+  uint64_t wall = gtstats_now() - start;
+  combined_finalize();
+
+  double sync = 0, total_sync, total_halo;
+  for(int t = 0; t < num_threads; t++)
+    sync += sync_ns[t].value / num_threads;
+  MPI_Reduce(&sync, &total_sync, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&halo_ns, &total_halo, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+  if(my_id == 0){
+    printf("%d processes x %d threads\n", num_processes, num_threads);
+    gtjacobi_report(stdout, &grid, done, residual, wall, total_sync / num_processes);
+    printf("Phases: halo %.1f%% of the master thread | barrier + residual %.1f%%\n",
+      100 * total_halo / num_processes / wall, 100 * total_sync / num_processes / wall);
+  }
+
+  free(a);
+  free(b);
+  free(sync_ns);
+  MPI_Finalize();
+  return 0;
+}
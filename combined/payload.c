@@ -0,0 +1,34 @@
+#include <stdlib.h>
+#include <mpi.h>
+#include <stdio.h>
+#include "combined.h"
+
+/*=============================================================
+Payload reduction
+=============================================================*/
+void combine_payload(double *acc, const double *in, int n, enum combined_op op){
+    for(int i=0; i<n; i++){
+        switch(op)
+        {
+            case combined_sum:
+                acc[i] += in[i];
+                break;
+            case combined_min:
+                if(in[i] < acc[i])
+                    acc[i] = in[i];
+                break;
+            case combined_max:
+                if(in[i] > acc[i])
+                    acc[i] = in[i];
+                break;
+        }
+    }
+}
+
+// n doubles must fit the fixed payload slots and buffers
+void combined_payload_check(int n){
+    if(n < 0 || n > COMBINED_MAX_PAYLOAD){
+        fprintf(stderr, "combined_allreduce: %d values, at most %d (COMBINED_MAX_PAYLOAD) per call\n", n, COMBINED_MAX_PAYLOAD);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+}
@@ -0,0 +1,196 @@
+#include <stdlib.h>
+#include <mpi.h>
+#include <stdio.h>
+#include "combined.h"
+#include "combined_trace.h"
+#include "gtarena.h"
+#include "gtmpi_schedule.h"
+
+/*=============================================================
+Tournament barrier (shared by every combined barrier)
+
+The tournament schedule and the MPI phase used to be copied into
+each combinedN.c; they live here so the plain barrier and the fused
+allreduce walk the exact same schedule. The roles come from
+mpi/gtmpi_schedule.c, the builder gtmpi2.c and the simulator use,
+written into one arena (GT_ARENA, see gtarena.h) with a region per
+process.
+=============================================================*/
+int P; // num_processes
+int vpid; // process id
+bool sense;
+static int num_tournament_rounds;
+static round_t **tournament_rounds;
+static gtarena_t arena;
+
+void tournament_init(int num_processes){
+    P = num_processes;
+    num_tournament_rounds = ceil(log2(P));
+    MPI_Comm_rank(MPI_COMM_WORLD, &vpid);
+    sense = true;
+
+    gtarena_begin(&arena, P, (num_tournament_rounds+1) * sizeof(round_t), GTARENA_SIZE(P * sizeof(round_t *)));
+    tournament_rounds = (round_t **)gtarena_alloc(&arena, P * sizeof(round_t *));
+    for(int i=0; i< P; i++){
+        tournament_rounds[i] = (round_t *)gtarena_region(&arena, i);
+    }
+
+    gtmpi_fill_schedule(tournament_rounds, P);
+    gtarena_place_here(&arena, vpid); // this rank only walks its own row
+}
+
+void tournament_finalize(){
+    // the arena stays mapped for the next tournament_init
+}
+
+void gtmpi_barrier(){ // MPI_Barrier(MPI_COMM_WORLD);
+    int tournament_round = 1; // first tournament_round
+    uint64_t span_begin;
+    int exit_arrival = 1;
+
+    if(num_tournament_rounds == 0) // single process: no round 1 to walk
+        return;
+
+    // arrival loop
+    while(exit_arrival){
+        switch(tournament_rounds[vpid][tournament_round].role)
+        {
+            case loser:
+                span_begin = TRACE_BEGIN();
+                MPI_Send(
+                    &sense, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD);
+                TRACE_END(span_send, tournament_round, span_begin);
+                span_begin = TRACE_BEGIN();
+                MPI_Recv(
+                    &tournament_rounds[vpid][tournament_round].flag, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                TRACE_END(span_recv, tournament_round, span_begin);
+                exit_arrival = 0; //exit loop
+                break;
+            case winner:
+                span_begin = TRACE_BEGIN();
+                MPI_Recv(
+                    &tournament_rounds[vpid][tournament_round].flag, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                TRACE_END(span_recv, tournament_round, span_begin);
+                break; // no need exit_arrival because champion will do in the last round
+            case champion:
+                span_begin = TRACE_BEGIN();
+                MPI_Recv(
+                    &tournament_rounds[vpid][tournament_round].flag, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                TRACE_END(span_recv, tournament_round, span_begin);
+                span_begin = TRACE_BEGIN();
+                MPI_Send(
+                    &sense, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD);
+                TRACE_END(span_send, tournament_round, span_begin);
+                exit_arrival = 0; // exit loop
+                break;
+            case bye: // do nothing
+            case dropout: // impossible
+                break;
+        }
+        if(exit_arrival)
+            tournament_round += 1; // move to next round
+    }
+
+    int exit_wakeup = 1;
+    while(exit_wakeup){
+        tournament_round -= 1;
+        switch(tournament_rounds[vpid][tournament_round].role)
+        {
+            case winner:
+                span_begin = TRACE_BEGIN();
+                MPI_Send(
+                    &sense, 1, MPI_C_BOOL, tournament_rounds[vpid][tournament_round].opponent, 0, MPI_COMM_WORLD);
+                TRACE_END(span_release, tournament_round, span_begin);
+                break;
+            case dropout:
+                exit_wakeup = 0; // exit loop when all round is done
+                break;
+            case loser: // impossible
+            case bye: // do nothing
+            case champion: // impossible
+                break;
+        }
+    }
+
+    sense = !sense; // reverse barrier
+}
+
+/*
+    Same walk as gtmpi_barrier, but the arrival messages carry the partial
+    reduction up to the champion and the wakeup messages carry the result
+    back down, so the barrier episode doubles as an allreduce.
+*/
+void gtmpi_allreduce(double *values, int n, enum combined_op op){
+    double incoming[COMBINED_MAX_PAYLOAD];
+    int tournament_round = 1; // first tournament_round
+    uint64_t span_begin;
+    int exit_arrival = 1;
+
+    combined_payload_check(n);
+    if(num_tournament_rounds == 0) // single process, nothing to exchange
+        return;
+
+    // arrival loop: partial results flow towards the champion
+    while(exit_arrival){
+        switch(tournament_rounds[vpid][tournament_round].role)
+        {
+            case loser:
+                span_begin = TRACE_BEGIN();
+                MPI_Send(
+                    values, n, MPI_DOUBLE, tournament_rounds[vpid][tournament_round].opponent, COMBINED_REDUCE_TAG, MPI_COMM_WORLD);
+                TRACE_END(span_send, tournament_round, span_begin);
+                span_begin = TRACE_BEGIN();
+                MPI_Recv( // wakeup carries the final result
+                    values, n, MPI_DOUBLE, tournament_rounds[vpid][tournament_round].opponent, COMBINED_REDUCE_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                TRACE_END(span_recv, tournament_round, span_begin);
+                exit_arrival = 0; //exit loop
+                break;
+            case winner:
+                span_begin = TRACE_BEGIN();
+                MPI_Recv(
+                    incoming, n, MPI_DOUBLE, tournament_rounds[vpid][tournament_round].opponent, COMBINED_REDUCE_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                TRACE_END(span_recv, tournament_round, span_begin);
+                combine_payload(values, incoming, n, op);
+                break;
+            case champion:
+                span_begin = TRACE_BEGIN();
+                MPI_Recv(
+                    incoming, n, MPI_DOUBLE, tournament_rounds[vpid][tournament_round].opponent, COMBINED_REDUCE_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                TRACE_END(span_recv, tournament_round, span_begin);
+                combine_payload(values, incoming, n, op);
+                span_begin = TRACE_BEGIN();
+                MPI_Send(
+                    values, n, MPI_DOUBLE, tournament_rounds[vpid][tournament_round].opponent, COMBINED_REDUCE_TAG, MPI_COMM_WORLD);
+                TRACE_END(span_send, tournament_round, span_begin);
+                exit_arrival = 0; // exit loop
+                break;
+            case bye: // do nothing
+            case dropout: // impossible
+                break;
+        }
+        if(exit_arrival)
+            tournament_round += 1; // move to next round
+    }
+
+    // wakeup loop: the result flows back down
+    int exit_wakeup = 1;
+    while(exit_wakeup){
+        tournament_round -= 1;
+        switch(tournament_rounds[vpid][tournament_round].role)
+        {
+            case winner:
+                span_begin = TRACE_BEGIN();
+                MPI_Send(
+                    values, n, MPI_DOUBLE, tournament_rounds[vpid][tournament_round].opponent, COMBINED_REDUCE_TAG, MPI_COMM_WORLD);
+                TRACE_END(span_release, tournament_round, span_begin);
+                break;
+            case dropout:
+                exit_wakeup = 0; // exit loop when all round is done
+                break;
+            case loser: // impossible
+            case bye: // do nothing
+            case champion: // impossible
+                break;
+        }
+    }
+}
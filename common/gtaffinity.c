@@ -0,0 +1,168 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+#include "gtaffinity.h"
+
+typedef struct{
+    int cpu;
+    int package;
+    int core;       // core_id, unique within a package
+    int core_rank;  // index of the core within its package
+    int smt;        // index of the cpu within its core
+} cpu_t;
+
+static int read_id(int cpu, const char *name, int fallback){
+    char path[128];
+    int id;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+        return fallback;
+    if (fscanf(f, "%d", &id) != 1)
+        id = fallback;
+    fclose(f);
+    return id;
+}
+
+static int by_package_core(const void *a, const void *b){
+    const cpu_t *x = a, *y = b;
+    if (x->package != y->package)
+        return x->package - y->package;
+    if (x->core != y->core)
+        return x->core - y->core;
+    return x->cpu - y->cpu;
+}
+
+static int by_smt_core_package(const void *a, const void *b){
+    const cpu_t *x = a, *y = b;
+    if (x->smt != y->smt)
+        return x->smt - y->smt;
+    if (x->core_rank != y->core_rank)
+        return x->core_rank - y->core_rank;
+    if (x->package != y->package)
+        return x->package - y->package;
+    return x->cpu - y->cpu;
+}
+
+// "0,2,4" or "0-3,8-11"
+static int parse_list(const char *text, int *cpus, int max){
+    int n = 0;
+    const char *p = text;
+
+    while (*p != '\0')
+    {
+        char *end;
+        long lo = strtol(p, &end, 10), hi = lo;
+        if (end == p || lo < 0)
+            return 0;
+        p = end;
+        if (*p == '-')
+        {
+            hi = strtol(p + 1, &end, 10);
+            if (end == p + 1 || hi < lo)
+                return 0;
+            p = end;
+        }
+        for (long c = lo; c <= hi && n < max; c++)
+            cpus[n++] = c;
+        if (*p == ',')
+            p++;
+        else if (*p != '\0')
+            return 0;
+    }
+    return n;
+}
+
+int gtaffinity_plan(gtaffinity_t *plan, const char *policy){
+    cpu_set_t allowed;
+    cpu_t cpus[GTAFFINITY_MAX_CPUS];
+    int n = 0, scatter;
+
+    snprintf(plan->policy, sizeof(plan->policy), "%s", policy);
+    plan->n = 0;
+    if (strcmp(policy, "none") == 0)
+        return 1;
+    if (strcmp(policy, "compact") != 0 && strcmp(policy, "scatter") != 0)
+    {
+        plan->n = parse_list(policy, plan->cpus, GTAFFINITY_MAX_CPUS);
+        return plan->n > 0;
+    }
+    scatter = strcmp(policy, "scatter") == 0;
+
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return 0;
+    for (int c = 0; c < CPU_SETSIZE && n < GTAFFINITY_MAX_CPUS; c++)
+    {
+        if (!CPU_ISSET(c, &allowed))
+            continue;
+        cpus[n].cpu = c;
+        cpus[n].package = read_id(c, "physical_package_id", 0);
+        cpus[n].core = read_id(c, "core_id", c);
+        n++;
+    }
+
+    // compact order; number the cores within each package and the cpus within each core
+    qsort(cpus, n, sizeof(cpu_t), by_package_core);
+    for (int i = 0; i < n; i++)
+    {
+        if (i == 0 || cpus[i].package != cpus[i - 1].package)
+        {
+            cpus[i].core_rank = 0;
+            cpus[i].smt = 0;
+        }
+        else if (cpus[i].core != cpus[i - 1].core)
+        {
+            cpus[i].core_rank = cpus[i - 1].core_rank + 1;
+            cpus[i].smt = 0;
+        }
+        else
+        {
+            cpus[i].core_rank = cpus[i - 1].core_rank;
+            cpus[i].smt = cpus[i - 1].smt + 1;
+        }
+    }
+    if (scatter)
+        qsort(cpus, n, sizeof(cpu_t), by_smt_core_package);
+
+    for (int i = 0; i < n; i++)
+        plan->cpus[i] = cpus[i].cpu;
+    plan->n = n;
+    return n > 0;
+}
+
+int gtaffinity_cpu(const gtaffinity_t *plan, int thread){
+    return plan->n > 0 ? plan->cpus[thread % plan->n] : -1;
+}
+
+int gtaffinity_pin(const gtaffinity_t *plan, int thread){
+    cpu_set_t set;
+    int cpu = gtaffinity_cpu(plan, thread);
+
+    if (cpu < 0)
+        return 1;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+void gtaffinity_from_env(gtaffinity_t *plan){
+    char *policy = getenv("GT_AFFINITY");
+
+    if (!gtaffinity_plan(plan, policy != NULL ? policy : "none"))
+    {
+        fprintf(stderr, "GT_AFFINITY=%s is not none, compact, scatter or a cpu list\n", policy);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void gtaffinity_report(FILE *out, const gtaffinity_t *plan, int num_threads){
+    fprintf(out, "Affinity %s:", plan->policy);
+    if (plan->n == 0)
+        fprintf(out, " threads not pinned");
+    for (int t = 0; t < num_threads && plan->n > 0; t++)
+        fprintf(out, " %d->%d", t, gtaffinity_cpu(plan, t));
+    fprintf(out, "\n");
+}
@@ -0,0 +1,36 @@
+#include <stdio.h>
+
+#ifndef GTAFFINITY_H
+#define GTAFFINITY_H
+
+/*
+    Thread placement for the pthreads harness (omp/pt_harness.c), or any
+    thread pool that runs the gtmp barriers. A plan lists CPUs in placement
+    order, and thread i runs on cpus[i % n]:
+        none        no pinning (the default)
+        compact     fill a core's hyperthreads, then the next core, then
+                    the next socket
+        scatter     one thread per socket in turn, then per core, then
+                    hyperthreads last
+        <list>      explicit CPUs, e.g. "0,2,4,6" or "0-3,8-11"
+    Only CPUs in the process's affinity mask are used (taskset, srun
+    --cpu-bind), and sockets/cores come from /sys/devices/system/cpu.
+    The harness reads the policy from GT_AFFINITY.
+*/
+#define GTAFFINITY_MAX_CPUS 1024
+
+typedef struct{
+    int n;                          // 0: not pinned
+    int cpus[GTAFFINITY_MAX_CPUS];
+    char policy[64];
+} gtaffinity_t;
+
+int gtaffinity_plan(gtaffinity_t *plan, const char *policy); // 0 if the policy is malformed
+int gtaffinity_cpu(const gtaffinity_t *plan, int thread);     // -1 if not pinned
+int gtaffinity_pin(const gtaffinity_t *plan, int thread);     // pins the calling thread; 0 on failure
+
+// from GT_AFFINITY, none if unset; exits on a bad policy
+void gtaffinity_from_env(gtaffinity_t *plan);
+void gtaffinity_report(FILE *out, const gtaffinity_t *plan, int num_threads);
+
+#endif
@@ -0,0 +1,143 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include "gtarena.h"
+
+static void configure(gtarena_t *arena){
+    char *options = getenv("GT_ARENA");
+
+    arena->want_huge = 0;
+    arena->numa = 0;
+    if (options != NULL)
+    {
+        char *copy = strdup(options), *save;
+        for (char *option = strtok_r(copy, ",", &save); option != NULL; option = strtok_r(NULL, ",", &save))
+        {
+            if (strcmp(option, "huge") == 0)
+                arena->want_huge = 1;
+            else if (strcmp(option, "numa") == 0)
+                arena->numa = 1;
+            else
+                fprintf(stderr, "GT_ARENA: ignoring unknown option %s\n", option);
+        }
+        free(copy);
+    }
+    arena->configured = 1;
+}
+
+// map at least bytes; sets arena->huge to the backing actually obtained
+static void map(gtarena_t *arena, size_t bytes){
+    char *base = MAP_FAILED;
+
+    arena->huge = 0;
+    if (arena->want_huge)
+    {
+        bytes = (bytes + GTARENA_HUGE_PAGE - 1) / GTARENA_HUGE_PAGE * GTARENA_HUGE_PAGE;
+        base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED)
+            arena->huge = 1;
+        else
+        {
+            // no hugetlbfs pool: over-map, trim to a 2 MB boundary and ask for THP
+            char *raw = mmap(NULL, bytes + GTARENA_HUGE_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (raw != MAP_FAILED)
+            {
+                size_t lead = (GTARENA_HUGE_PAGE - (size_t)raw % GTARENA_HUGE_PAGE) % GTARENA_HUGE_PAGE;
+                if (lead > 0)
+                    munmap(raw, lead);
+                munmap(raw + lead + bytes, GTARENA_HUGE_PAGE - lead);
+                base = raw + lead;
+                arena->huge = madvise(base, bytes, MADV_HUGEPAGE) == 0 ? 2 : 0;
+            }
+        }
+    }
+    if (base == MAP_FAILED)
+        base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+    {
+        perror("gtarena: mmap");
+        exit(EXIT_FAILURE);
+    }
+    arena->base = base;
+    arena->capacity = bytes;
+}
+
+void gtarena_begin(gtarena_t *arena, int regions, size_t region_bytes, size_t shared_bytes){
+    if (!arena->configured)
+        configure(arena);
+
+    size_t page = arena->want_huge ? GTARENA_HUGE_PAGE : (size_t)sysconf(_SC_PAGESIZE);
+    size_t align = arena->numa ? page : GTARENA_LINE;
+    size_t stride = (region_bytes + align - 1) / align * align;
+    size_t bytes = regions * stride + GTARENA_SIZE(shared_bytes);
+
+    int remapped = arena->base == NULL || bytes > arena->capacity;
+    if (remapped)
+    {
+        if (arena->base != NULL)
+            munmap(arena->base, arena->capacity);
+        map(arena, bytes);
+    }
+    else
+        memset(arena->base, 0, bytes); // fresh mappings are already zero
+
+    // a region keeps its node while it covers the same pages of the same mapping
+    if (arena->numa)
+    {
+        if (regions > arena->placed_regions)
+        {
+            arena->placed = (unsigned char*)realloc(arena->placed, regions);
+            if (arena->placed == NULL)
+            {
+                fprintf(stderr, "gtarena: cannot allocate placement flags for %d regions\n", regions);
+                exit(EXIT_FAILURE);
+            }
+            memset(arena->placed + arena->placed_regions, 0, regions - arena->placed_regions);
+            arena->placed_regions = regions;
+        }
+        if (remapped || stride != arena->region_stride)
+            memset(arena->placed, 0, arena->placed_regions);
+    }
+
+    arena->regions = regions;
+    arena->region_bytes = region_bytes;
+    arena->region_stride = stride;
+    arena->used = regions * stride;
+}
+
+void *gtarena_region(gtarena_t *arena, int i){
+    return arena->base + i * arena->region_stride;
+}
+
+void *gtarena_alloc(gtarena_t *arena, size_t bytes){
+    void *p = arena->base + arena->used;
+
+    arena->used += GTARENA_SIZE(bytes);
+    if (arena->used > arena->capacity)
+    {
+        fprintf(stderr, "gtarena: layout exceeds the %zu bytes reserved\n", arena->capacity);
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+void gtarena_place(gtarena_t *arena, int i){
+    unsigned cpu, node;
+    unsigned long mask[16] = {0};
+
+    // tried once per mapping, whether or not the kernel moves the pages
+    arena->placed[i] = 1;
+    if (arena->region_bytes == 0)
+        return;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0 || node >= 8 * sizeof(mask))
+        return;
+    mask[node / (8 * sizeof(unsigned long))] |= 1ul << (node % (8 * sizeof(unsigned long)));
+    // best effort: pages stay where they are if the kernel refuses
+    syscall(SYS_mbind, gtarena_region(arena, i), arena->region_stride, MPOL_PREFERRED,
+            mask, 8 * sizeof(mask), MPOL_MF_MOVE);
+}
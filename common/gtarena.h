@@ -0,0 +1,63 @@
+#include <stddef.h>
+
+#ifndef GTARENA_H
+#define GTARENA_H
+
+/*
+    Barrier state from one mapping. gtarena_begin lays out a team: one
+    region per thread (or rank) followed by a shared part, all zeroed.
+    The mapping is kept when the barrier is finalized, and the next begin
+    reuses it when it is large enough, so re-initializing a barrier
+    between experiments makes no heap or mmap calls.
+
+    GT_ARENA selects the backing, comma-separated:
+        huge    2 MB pages: MAP_HUGETLB from the hugetlbfs pool, else
+                transparent huge pages via madvise(MADV_HUGEPAGE) on a
+                2 MB-aligned mapping, else plain pages
+        numa    every region starts on its own page, and
+                gtarena_place_here moves it to the calling thread's NUMA
+                node; barriers call it from the owning thread (or rank) on
+                its first episode, so each thread's flags live next to it
+                (with huge pages, each region takes a 2 MB page). A region
+                moves once per mapping: later calls, including those after
+                re-initializing on the same mapping, only test a flag, so
+                the getcpu and mbind calls stay out of every experiment
+                but the first.
+    Unset, the arena is plain pages with 64-byte aligned regions.
+*/
+#define GTARENA_LINE 64
+#define GTARENA_HUGE_PAGE (2u << 20)
+
+// bytes one gtarena_alloc of n takes from the shared part
+#define GTARENA_SIZE(n) (((n) + GTARENA_LINE - 1) / GTARENA_LINE * GTARENA_LINE)
+
+typedef struct{
+    char *base;
+    size_t capacity;
+    size_t used;
+    size_t region_stride;
+    size_t region_bytes;
+    int regions;
+    int want_huge;
+    int huge;     // backing obtained: 0 plain, 1 MAP_HUGETLB, 2 transparent huge pages
+    int numa;
+    int configured;
+    unsigned char *placed;  // per region: moved by gtarena_place_here (numa only)
+    int placed_regions;
+} gtarena_t;
+
+// regions of region_bytes each, then shared_bytes (the sum of GTARENA_SIZE of every gtarena_alloc)
+void gtarena_begin(gtarena_t *arena, int regions, size_t region_bytes, size_t shared_bytes);
+void *gtarena_region(gtarena_t *arena, int i);
+void *gtarena_alloc(gtarena_t *arena, size_t bytes);   // from the shared part, 64-byte aligned
+
+void gtarena_place(gtarena_t *arena, int i);
+
+// region i to the calling thread's NUMA node, unless it was moved already;
+// a no-op unless GT_ARENA has numa
+static inline void gtarena_place_here(gtarena_t *arena, int i){
+    if (arena->numa && !arena->placed[i])
+        gtarena_place(arena, i);
+}
+
+#endif
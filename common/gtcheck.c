@@ -0,0 +1,106 @@
+#include <sched.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "gtcheck.h"
+
+static char watched[256];
+
+static void watchdog_fired(int signal){
+    (void)signal;
+    (void)!write(STDERR_FILENO, watched, strlen(watched)); // async-signal-safe, unlike fprintf
+    _exit(EXIT_FAILURE);
+}
+
+void gtcheck_delay(const gtwork_t *work, int participant, int P, uint64_t episode){
+    uint64_t ns = gtwork_ns(work, participant, P, episode);
+
+    if (ns & 1)
+        sched_yield();
+    gtwork_spin(ns);
+}
+
+int gtcheck_teams(const char *list, int *teams){
+    int n = 0;
+    char *end;
+
+    for (const char *p = list; *p != '\0'; p = *end == ',' ? end + 1 : end)
+    {
+        long team = strtol(p, &end, 10);
+        if (end == p || team < 1 || n == GTCHECK_TEAMS_MAX || (*end != ',' && *end != '\0'))
+            return 0;
+        teams[n++] = (int)team;
+    }
+    return n;
+}
+
+int gtcheck_baseline(const char *path, const char *name, const char *team, double *median_ns, char *other_team){
+    FILE *in = fopen(path, "r");
+    char line[256], line_name[128], line_team[GTCHECK_TEAM_MAX];
+    double value;
+    int found = 0;
+
+    other_team[0] = '\0';
+    if (in == NULL)
+        return 0;
+    while (!found && fgets(line, sizeof(line), in) != NULL)
+    {
+        if (line[0] == '#' || sscanf(line, "%127s %31s %lf", line_name, line_team, &value) != 3)
+            continue;
+        if (strcmp(line_name, name) != 0)
+            continue;
+        if (strcmp(line_team, team) == 0)
+        {
+            *median_ns = value;
+            found = 1;
+        }
+        else
+            strcpy(other_team, line_team);
+    }
+    fclose(in);
+    return found;
+}
+
+int gtcheck_regression(FILE *out, const char *path, const char *name, const char *team, double median_ns, double slack){
+    char other_team[GTCHECK_TEAM_MAX];
+    double baseline;
+
+    if (!gtcheck_baseline(path, name, team, &baseline, other_team))
+    {
+        fprintf(out, "%s: median %.0f ns at %s; no baseline for %s in %s%s%s: FAILED"
+                     " (make baseline records one, -s 0 skips the regression test)\n",
+            name, median_ns, team, team, path, other_team[0] != '\0' ? ", only for " : "", other_team);
+        return 1;
+    }
+    int failed = median_ns > slack * baseline;
+    fprintf(out, "%s: median %.0f ns at %s, baseline %.0f ns (limit %.0f): %s\n",
+        name, median_ns, team, baseline, slack * baseline, failed ? "REGRESSION" : "ok");
+    return failed;
+}
+
+void gtcheck_watchdog(const char *what, unsigned seconds){
+    alarm(0);
+    if (seconds == 0)
+        return;
+    snprintf(watched, sizeof(watched), "%s: no progress for %u s (hang?)\n", what, seconds);
+    signal(SIGALRM, watchdog_fired);
+    alarm(seconds);
+}
+
+void gtcheck_record(FILE *out, const char *name, const char *team, double median_ns){
+    fprintf(out, "%s %s %.0f\n", name, team, median_ns);
+}
+
+void gtcheck_baseline_path(char *path, size_t size){
+    char host[256];
+
+    gethostname(host, sizeof(host));
+    host[sizeof(host) - 1] = '\0';
+    snprintf(path, size, "%s.%s", GTCHECK_BASELINE, host);
+}
+
+const char *gtcheck_basename(const char *path){
+    const char *slash = strrchr(path, '/');
+    return slash != NULL ? slash + 1 : path;
+}
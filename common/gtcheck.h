@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <stdint.h>
+#include "gtwork.h"
+
+#ifndef GTCHECK_H
+#define GTCHECK_H
+
+/*
+    Shared pieces of the stress/regression drivers behind make check
+    (omp/gtmp_check.c, mpi/gtmpi_check.c, combined/combined_check.c).
+    A check has two parts:
+        stress      every team size from 1 to the maximum, each for a
+                    number of episodes with random delays before every
+                    arrival. Each participant bumps the episode's arrival
+                    counter before the barrier and reads it after: anything
+                    short of the team size means somebody left episode N
+                    before everybody arrived.
+        regression  the median episode latency at fixed team sizes
+                    (GTCHECK_TEAMS participants, whatever the machine;
+                    teams larger than its CPUs spin with sched_yield),
+                    without delays, against a stored baseline. The lowest
+                    median of GTCHECK_REPEATS runs counts, since one run
+                    of an oversubscribed team can lose whole quanta
+    Baseline files hold one "<name> <team> <median_ns>" line per barrier
+    and team, '#' starts a comment. Latencies only compare on the machine
+    that recorded them, so the files are per host (check.baseline.<host>,
+    never committed): make check records one on its first run on a host
+    and make baseline rewrites it. A median above slack * baseline fails
+    the check, and so does a team with no baseline line; -s 0 (slack 0)
+    skips the regression part instead.
+
+    A barrier that loses a wakeup hangs instead of letting someone through
+    early, so every team runs under a watchdog: no progress for
+    GTCHECK_TIMEOUT seconds fails the check.
+*/
+#define GTCHECK_WORK "pareto:2000:1.5"
+#define GTCHECK_BASELINE "check.baseline" // .<host> appended
+#define GTCHECK_SLACK 1.5
+#define GTCHECK_TEAMS "4,8"   // regression teams, in participants
+#define GTCHECK_TEAMS_MAX 8
+#define GTCHECK_REPEATS 5
+#define GTCHECK_TEAM_MAX 32
+#define GTCHECK_TIMEOUT 120 // seconds per team
+
+// the stress delay before an arrival: the workload's draw, and a
+// sched_yield on odd draws so arrival order also depends on the scheduler
+void gtcheck_delay(const gtwork_t *work, int participant, int P, uint64_t episode);
+
+// "4,8" into teams[GTCHECK_TEAMS_MAX]; the count, 0 if malformed
+int gtcheck_teams(const char *list, int *teams);
+
+// 1 and *median_ns filled if path has a line for name at team; *other_team gets a team recorded for name otherwise
+int gtcheck_baseline(const char *path, const char *name, const char *team, double *median_ns, char *other_team);
+
+// this host's baseline file, GTCHECK_BASELINE ".<host>"
+void gtcheck_baseline_path(char *path, size_t size);
+
+// report median against the baseline in path; 0 if it passes, 1 on a regression or no baseline
+int gtcheck_regression(FILE *out, const char *path, const char *name, const char *team, double median_ns, double slack);
+
+// (re)arm the watchdog: if not re-armed or stopped within seconds, print what and exit 1; 0 stops it
+void gtcheck_watchdog(const char *what, unsigned seconds);
+
+// one baseline line
+void gtcheck_record(FILE *out, const char *name, const char *team, double median_ns);
+
+// name without the directory, for binaries named after their barrier
+const char *gtcheck_basename(const char *path);
+
+#endif
@@ -0,0 +1,98 @@
+#include <stdlib.h>
+#include "gtjacobi.h"
+
+int gtjacobi_parse(gtjacobi_grid_t *grid, const char *spec){
+    int used = -1, fields = 3;
+
+    // %n is only stored once every field before it matched, so used says which form fit
+    sscanf(spec, "%dx%dx%d%n", &grid->nx, &grid->ny, &grid->nz, &used);
+    if (used < 0)
+    {
+        fields = 2;
+        grid->nz = 1;
+        sscanf(spec, "%dx%d%n", &grid->nx, &grid->ny, &used);
+    }
+    if (used < 0 || spec[used] != '\0')
+        return 0;
+    if (grid->nx < 1 || grid->ny < 1 || grid->nz < 1)
+        return 0;
+
+    grid->dims = fields;
+    if (grid->dims == 2)
+    {
+        grid->planes = grid->ny;
+        grid->plane = grid->nx + 2;
+    }
+    else
+    {
+        grid->planes = grid->nz;
+        grid->plane = (size_t)(grid->nx + 2) * (grid->ny + 2);
+    }
+    return 1;
+}
+
+double *gtjacobi_alloc(const gtjacobi_grid_t *grid, int planes, int top){
+    double *slab = (double*)calloc((planes + 2) * grid->plane, sizeof(double));
+
+    if (slab != NULL && top)
+    {
+        for (size_t i = 0; i < grid->plane; i++)
+            slab[i] = GTJACOBI_TOP;
+    }
+    return slab;
+}
+
+void gtjacobi_split(int planes, int parts, int part, int *first, int *last){
+    int base = planes / parts, extra = planes % parts;
+
+    *first = 1 + part * base + (part < extra ? part : extra);
+    *last = *first + base + (part < extra) - 1;
+}
+
+double gtjacobi_sweep(const gtjacobi_grid_t *grid, const double *restrict old, double *restrict new, int first, int last){
+    const size_t plane = grid->plane, row = grid->nx + 2;
+    double sum = 0;
+
+    for (int p = first; p <= last; p++)
+    {
+        if (grid->dims == 2)
+        {
+            const double *c = old + p * plane;
+            double *out = new + p * plane;
+            for (int i = 1; i <= grid->nx; i++)
+            {
+                double v = 0.25 * (c[i - 1] + c[i + 1] + c[i - plane] + c[i + plane]);
+                sum += (v - c[i]) * (v - c[i]);
+                out[i] = v;
+            }
+            continue;
+        }
+        for (int j = 1; j <= grid->ny; j++)
+        {
+            const double *c = old + p * plane + j * row;
+            double *out = new + p * plane + j * row;
+            for (int i = 1; i <= grid->nx; i++)
+            {
+                double v = (c[i - 1] + c[i + 1] + c[i - row] + c[i + row] + c[i - plane] + c[i + plane]) / 6;
+                sum += (v - c[i]) * (v - c[i]);
+                out[i] = v;
+            }
+        }
+    }
+    return sum;
+}
+
+void gtjacobi_report(FILE *out, const gtjacobi_grid_t *grid, int iterations, double residual,
+                     uint64_t wall_ns, double sync_ns){
+    double seconds = wall_ns / 1e9;
+    double points = (double)grid->nx * grid->ny * grid->nz * iterations;
+
+    if (grid->dims == 2)
+        fprintf(out, "Jacobi %dx%d", grid->nx, grid->ny);
+    else
+        fprintf(out, "Jacobi %dx%dx%d", grid->nx, grid->ny, grid->nz);
+    fprintf(out, ": %d iterations in %.3f s | %.1f iterations/s | %.1f Mpoints/s | residual %.3e\n",
+        iterations, seconds, iterations / seconds, points / seconds / 1e6, residual);
+    fprintf(out, "Time in synchronization: %.1f%% (%.0f ns per iteration)\n",
+        100 * sync_ns / wall_ns, sync_ns / iterations);
+}
@@ -0,0 +1,50 @@
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef GTJACOBI_H
+#define GTJACOBI_H
+
+/*
+    Jacobi relaxation of the Laplace equation, the kernel of the
+    bulk-synchronous mini-apps (omp/jacobi.c, mpi/jacobi.c,
+    combined/jacobi.c). It shows what a barrier costs in time to solution
+    rather than in a tight loop.
+
+    The grid is NXxNY (5-point stencil) or NXxNYxNZ (7-point stencil) of
+    interior points with fixed boundaries: GTJACOBI_TOP on the first plane,
+    0 everywhere else. It is decomposed along its last axis into planes,
+    rows in 2D and xy-slices in 3D. A slab of n planes is stored with one
+    halo plane on each side (plane 0 and n + 1), and every plane carries
+    its own halo ring of boundary cells.
+
+    Each iteration computes new from old over the slab's planes. The
+    residual is the L2 norm of the update: the square root of the sum,
+    over all workers, of what gtjacobi_sweep returns.
+*/
+#define GTJACOBI_TOP 1.0
+
+typedef struct{
+    int nx, ny, nz;   // interior points, nz = 1 for a 2D grid
+    int dims;
+    int planes;       // along the decomposed axis: ny in 2D, nz in 3D
+    size_t plane;     // doubles per plane, halo ring included
+} gtjacobi_grid_t;
+
+// "512x512" or "64x64x64"; 0 if the spec is malformed
+int gtjacobi_parse(gtjacobi_grid_t *grid, const char *spec);
+
+// zeroed slab of planes + 2 planes; top sets plane 0 to GTJACOBI_TOP (the slab holds global plane 1)
+double *gtjacobi_alloc(const gtjacobi_grid_t *grid, int planes, int top);
+
+// planes first..last (1-based, inclusive) of part out of parts, in contiguous blocks
+void gtjacobi_split(int planes, int parts, int part, int *first, int *last);
+
+// relax planes first..last of old into new; returns the sum of squared updates
+double gtjacobi_sweep(const gtjacobi_grid_t *grid, const double *restrict old, double *restrict new, int first, int last);
+
+// time-to-solution summary; sync_ns is the mean per worker time spent synchronizing
+void gtjacobi_report(FILE *out, const gtjacobi_grid_t *grid, int iterations, double residual,
+                     uint64_t wall_ns, double sync_ns);
+
+#endif
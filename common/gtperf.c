@@ -0,0 +1,123 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "gtperf.h"
+
+static const char *event_names[GTPERF_EVENTS] = {
+    "cycles", "instructions", "llc-misses", "ctx-switches", "migrations", "raw"
+};
+
+static int open_event(uint32_t type, uint64_t config){
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    // count kernel time when allowed (spinning in futex/sched shows up there)
+    int fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd < 0)
+    {
+        attr.exclude_kernel = 1;
+        fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    return fd;
+}
+
+int gtperf_open(gtperf_t *perf){
+    char *raw = getenv("GT_PERF_RAW");
+    int opened = 0;
+
+    perf->fds[gtperf_cycles] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    perf->fds[gtperf_instructions] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    perf->fds[gtperf_llc_misses] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    perf->fds[gtperf_context_switches] = open_event(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES);
+    perf->fds[gtperf_migrations] = open_event(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS);
+    perf->fds[gtperf_raw] = raw != NULL ? open_event(PERF_TYPE_RAW, strtoull(raw, NULL, 16)) : -1;
+
+    for (int i = 0; i < GTPERF_EVENTS; i++)
+    {
+        if (perf->fds[i] >= 0)
+            opened++;
+    }
+    return opened;
+}
+
+void gtperf_start(gtperf_t *perf){
+    for (int i = 0; i < GTPERF_EVENTS; i++)
+    {
+        if (perf->fds[i] < 0)
+            continue;
+        ioctl(perf->fds[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(perf->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void gtperf_stop(gtperf_t *perf, gtperf_counts_t *counts){
+    for (int i = 0; i < GTPERF_EVENTS; i++)
+    {
+        if (perf->fds[i] >= 0)
+            ioctl(perf->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    for (int i = 0; i < GTPERF_EVENTS; i++)
+    {
+        uint64_t data[3]; // value, time enabled, time running
+        if (perf->fds[i] < 0 || read(perf->fds[i], data, sizeof(data)) != sizeof(data))
+            continue;
+
+        double value = data[0];
+        if (data[2] > 0 && data[2] < data[1])
+            value *= (double)data[1] / data[2]; // multiplexed: scale up
+        counts->value[i] += value;
+        counts->valid[i]++;
+    }
+}
+
+void gtperf_close(gtperf_t *perf){
+    for (int i = 0; i < GTPERF_EVENTS; i++)
+    {
+        if (perf->fds[i] >= 0)
+            close(perf->fds[i]);
+        perf->fds[i] = -1;
+    }
+}
+
+void gtperf_counts_init(gtperf_counts_t *counts){
+    memset(counts, 0, sizeof(*counts));
+}
+
+void gtperf_counts_merge(gtperf_counts_t *dst, const gtperf_counts_t *src){
+    for (int i = 0; i < GTPERF_EVENTS; i++)
+    {
+        dst->value[i] += src->value[i];
+        dst->valid[i] += src->valid[i];
+    }
+}
+
+void gtperf_report(FILE *out, const char *label, const gtperf_counts_t *counts, uint64_t episodes){
+    const char *separator = " ";
+    fprintf(out, "%s (summed over all threads and ranks, per episode, %llu episodes):", label, (unsigned long long)episodes);
+    for (int i = 0; i < GTPERF_EVENTS; i++)
+    {
+        if (counts->valid[i] == 0)
+        {
+            if (i != gtperf_raw)
+                fprintf(out, "%s%s n/a", separator, event_names[i]);
+        }
+        else
+        {
+            fprintf(out, "%s%s %.1f", separator, event_names[i], counts->value[i] / episodes);
+        }
+        separator = " | ";
+    }
+    if (counts->valid[gtperf_cycles] > 0 && counts->valid[gtperf_instructions] > 0 && counts->value[gtperf_cycles] > 0)
+        fprintf(out, " | IPC %.2f", counts->value[gtperf_instructions] / counts->value[gtperf_cycles]);
+    fprintf(out, "\n");
+}
@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <stdint.h>
+
+#ifndef GTPERF_H
+#define GTPERF_H
+
+/*
+    Per-thread hardware counters around the barrier loop (GT_PERF=1).
+
+    gtperf_open() opens, for the calling thread, cycles, instructions,
+    LLC misses, context switches, CPU migrations, and one optional raw
+    PMU event from GT_PERF_RAW=<hex config>. Use the raw event for a
+    coherence/HITM event; its encoding is model specific (for example
+    MEM_LOAD_L3_HIT_RETIRED.XSNP_HITM on recent Intel cores). Each counter
+    is opened on its own, so a PMU that lacks an event (or a VM with no PMU
+    at all) only loses that column. Counts are scaled for multiplexing.
+*/
+enum gtperf_event{
+    gtperf_cycles = 0,
+    gtperf_instructions,
+    gtperf_llc_misses,
+    gtperf_context_switches,
+    gtperf_migrations,
+    gtperf_raw,
+    GTPERF_EVENTS
+};
+
+typedef struct{
+    int fds[GTPERF_EVENTS];
+} gtperf_t;
+
+typedef struct{
+    double value[GTPERF_EVENTS];
+    int valid[GTPERF_EVENTS]; // number of threads/ranks that had the counter
+} gtperf_counts_t;
+
+int gtperf_open(gtperf_t *perf); // returns how many counters opened
+void gtperf_start(gtperf_t *perf);
+void gtperf_stop(gtperf_t *perf, gtperf_counts_t *counts); // accumulates into counts
+void gtperf_close(gtperf_t *perf);
+
+void gtperf_counts_init(gtperf_counts_t *counts);
+void gtperf_counts_merge(gtperf_counts_t *dst, const gtperf_counts_t *src);
+
+// counts per barrier episode for the whole team
+void gtperf_report(FILE *out, const char *label, const gtperf_counts_t *counts, uint64_t episodes);
+
+#endif
@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+#include "gtspin.h"
+
+#define UMWAIT_TSC_TICKS 100000 // re-check the word at least this often
+
+enum gtspin_policy gtspin_policy = GTSPIN_DEFAULT;
+
+static const char *policy_names[] = {
+    "busy", "pause", "backoff", "proportional", "umwait", "yield"
+};
+static int initialized = 0;
+
+static int cpu_has_waitpkg(void){
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return (ecx >> 5) & 1; // CPUID.(EAX=7,ECX=0):ECX[bit 5] = WAITPKG
+#endif
+    return 0;
+}
+
+void gtspin_init(void){
+    char *requested = getenv("GT_SPIN");
+
+    if (initialized)
+        return;
+    initialized = 1;
+    if (requested == NULL)
+        return;
+
+    int found = 0;
+    for (int i = 0; i < (int)(sizeof(policy_names) / sizeof(policy_names[0])); i++)
+    {
+        if (strcmp(requested, policy_names[i]) == 0)
+        {
+            gtspin_policy = (enum gtspin_policy)i;
+            found = 1;
+        }
+    }
+    if (!found)
+        fprintf(stderr, "GT_SPIN=%s is not a known spin strategy, using %s\n", requested, gtspin_name());
+
+    if (gtspin_policy == gtspin_umwait && !cpu_has_waitpkg())
+    {
+        fprintf(stderr, "GT_SPIN=umwait: this CPU has no WAITPKG, using pause\n");
+        gtspin_policy = gtspin_pause;
+    }
+}
+
+const char *gtspin_name(void){
+    return policy_names[gtspin_policy];
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("waitpkg")))
+void gtspin_umwait_until(volatile int *word, int value){
+    while (*word != value)
+    {
+        _umonitor((void*)word);
+        if (*word == value) // written between the read and the monitor
+            break;
+        _umwait(1, __rdtsc() + UMWAIT_TSC_TICKS); // C0.1: the faster wake-up state
+    }
+}
+#else
+void gtspin_umwait_until(volatile int *word, int value){
+    while (*word != value)
+        gtspin_relax();
+}
+#endif
@@ -0,0 +1,128 @@
+#include <stddef.h>
+#include <sched.h>
+
+#ifndef GTSPIN_H
+#define GTSPIN_H
+
+/*
+    How a thread waits for a shared word to reach a value.
+
+    Every shared-memory spin loop calls gtspin_until() instead of
+    `while (*word != value);`. The strategy is picked once per process by
+    gtspin_init() from GT_SPIN=<name>:
+        busy          re-read the word as fast as possible (the old loops)
+        pause         re-read with the CPU's pause hint in between, which
+                      frees pipeline slots for the SMT sibling
+        backoff       exponential: wait 1, 2, 4, ... pauses between reads,
+                      capped at GTSPIN_UNIT pauses per outstanding waiter
+        proportional  wait GTSPIN_UNIT pauses per outstanding waiter before
+                      every read (Anderson's proportional backoff)
+        umwait        umonitor/umwait on the word's cache line, so the core
+                      sleeps until the line is written; falls back to pause
+                      when cpuid does not report WAITPKG
+        yield         sched_yield() between reads, for oversubscribed runs
+    The default is busy; building with -DGTSPIN_DEFAULT=<policy> changes it.
+
+    outstanding points at a count of threads that still have to arrive (the
+    centralized barrier's counter) and scales the backoff; NULL means one.
+    The backoff strategies keep re-reading it, so waiters speed up as the
+    episode fills and the last arriver gets the line to itself. left is
+    that count as this waiter saw it when it arrived, and bounds every
+    read: the last arriver resets the counter to P just before it releases
+    the waiters, and a waiter that reads P then would otherwise back off
+    for the longest delay at the moment of release.
+*/
+enum gtspin_policy {
+    gtspin_busy,
+    gtspin_pause,
+    gtspin_backoff,
+    gtspin_proportional,
+    gtspin_umwait,
+    gtspin_yield
+};
+
+#ifndef GTSPIN_DEFAULT
+#define GTSPIN_DEFAULT gtspin_busy
+#endif
+
+#define GTSPIN_UNIT 32          // pauses per outstanding waiter
+#define GTSPIN_MAX_DELAY 4096   // upper bound on pauses between reads
+
+extern enum gtspin_policy gtspin_policy;
+
+void gtspin_init(void);          // reads GT_SPIN; cheap to call again
+const char *gtspin_name(void);
+void gtspin_umwait_until(volatile int *word, int value);
+
+static inline void gtspin_relax(void){
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// one wait between reads, for loops that gtspin_until cannot express
+// (several words, 64-bit words): sched_yield under yield, else pause
+static inline void gtspin_poll(void){
+    if (gtspin_policy == gtspin_yield)
+        sched_yield();
+    else
+        gtspin_relax();
+}
+
+static inline int gtspin_outstanding(volatile const int *outstanding, int left){
+    int n = outstanding != NULL ? *outstanding : 1;
+    if (n > left) // the counter was reset for the next episode
+        n = left;
+    return n > 0 ? n : 1;
+}
+
+static inline __attribute__((always_inline)) void gtspin_until(volatile int *word, int value, volatile const int *outstanding, int left){
+    if (*word == value)
+        return;
+
+    switch (gtspin_policy)
+    {
+        case gtspin_busy:
+            while (*word != value);
+            break;
+        case gtspin_pause:
+            while (*word != value)
+                gtspin_relax();
+            break;
+        case gtspin_backoff:
+        {
+            int delay = 1;
+            while (*word != value)
+            {
+                for (int i = 0; i < delay; i++)
+                    gtspin_relax();
+                int cap = GTSPIN_UNIT * gtspin_outstanding(outstanding, left);
+                delay = 2 * delay < cap ? 2 * delay : cap;
+                if (delay > GTSPIN_MAX_DELAY)
+                    delay = GTSPIN_MAX_DELAY;
+            }
+            break;
+        }
+        case gtspin_proportional:
+            while (*word != value)
+            {
+                int delay = GTSPIN_UNIT * gtspin_outstanding(outstanding, left);
+                if (delay > GTSPIN_MAX_DELAY)
+                    delay = GTSPIN_MAX_DELAY;
+                for (int i = 0; i < delay; i++)
+                    gtspin_relax();
+            }
+            break;
+        case gtspin_umwait:
+            gtspin_umwait_until(word, value);
+            break;
+        case gtspin_yield:
+            while (*word != value)
+                sched_yield();
+            break;
+    }
+}
+
+#endif
@@ -0,0 +1,119 @@
+#include <string.h>
+#include "gtstats.h"
+
+static int bucket_index(uint64_t value){
+    if (value < 2 * GTSTATS_SUB_BUCKETS)
+        return (int)value; // exact below 32
+
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - GTSTATS_SUB_BUCKET_BITS;
+    int sub = (int)(value >> shift) & (GTSTATS_SUB_BUCKETS - 1);
+    return (msb - GTSTATS_SUB_BUCKET_BITS + 1) * GTSTATS_SUB_BUCKETS + sub;
+}
+
+// largest value that maps to the bucket (HDR "highest equivalent value")
+static uint64_t bucket_upper(int index){
+    if (index < 2 * GTSTATS_SUB_BUCKETS)
+        return (uint64_t)index;
+
+    int msb = index / GTSTATS_SUB_BUCKETS + GTSTATS_SUB_BUCKET_BITS - 1;
+    int shift = msb - GTSTATS_SUB_BUCKET_BITS;
+    uint64_t low = (uint64_t)(GTSTATS_SUB_BUCKETS + index % GTSTATS_SUB_BUCKETS) << shift;
+    return low + ((1ull << shift) - 1);
+}
+
+void gtstats_hist_init(gtstats_hist_t *h){
+    memset(h, 0, sizeof(*h));
+    h->min = UINT64_MAX;
+}
+
+void gtstats_hist_record(gtstats_hist_t *h, uint64_t value){
+    h->buckets[bucket_index(value)]++;
+    h->count++;
+    h->sum += value;
+    if (value < h->min)
+        h->min = value;
+    if (value > h->max)
+        h->max = value;
+}
+
+void gtstats_hist_merge(gtstats_hist_t *dst, const gtstats_hist_t *src){
+    for (int i = 0; i < GTSTATS_BUCKETS; i++)
+    {
+        dst->buckets[i] += src->buckets[i];
+    }
+    dst->count += src->count;
+    dst->sum += src->sum;
+    if (src->min < dst->min)
+        dst->min = src->min;
+    if (src->max > dst->max)
+        dst->max = src->max;
+}
+
+uint64_t gtstats_hist_percentile(const gtstats_hist_t *h, double percentile){
+    if (h->count == 0)
+        return 0;
+
+    uint64_t rank = (uint64_t)(percentile / 100.0 * h->count + 0.5);
+    if (rank < 1)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < GTSTATS_BUCKETS; i++)
+    {
+        seen += h->buckets[i];
+        if (seen >= rank)
+        {
+            uint64_t value = bucket_upper(i);
+            if (value > h->max)
+                value = h->max;
+            if (value < h->min)
+                value = h->min;
+            return value;
+        }
+    }
+    return h->max;
+}
+
+void gtstats_hist_report(FILE *out, const char *label, const gtstats_hist_t *h, int detail){
+    if (h->count == 0)
+    {
+        fprintf(out, "%s: no episodes recorded\n", label);
+        return;
+    }
+
+    fprintf(out, "%s (ns, %llu episodes): min %llu | p50 %llu | p90 %llu | p99 %llu | p99.9 %llu | max %llu | mean %.1f\n",
+        label, (unsigned long long)h->count,
+        (unsigned long long)h->min,
+        (unsigned long long)gtstats_hist_percentile(h, 50.0),
+        (unsigned long long)gtstats_hist_percentile(h, 90.0),
+        (unsigned long long)gtstats_hist_percentile(h, 99.0),
+        (unsigned long long)gtstats_hist_percentile(h, 99.9),
+        (unsigned long long)h->max,
+        h->sum / h->count);
+
+    if (!detail)
+        return;
+
+    // HdrHistogram-style percentile distribution, one row per non-empty bucket
+    fprintf(out, "%12s %14s %12s %16s\n", "Value", "Percentile", "TotalCount", "1/(1-Percentile)");
+    uint64_t seen = 0;
+    for (int i = 0; i < GTSTATS_BUCKETS; i++)
+    {
+        if (h->buckets[i] == 0)
+            continue;
+
+        seen += h->buckets[i];
+        double fraction = (double)seen / h->count;
+        uint64_t value = bucket_upper(i);
+        if (value > h->max)
+            value = h->max;
+
+        if (seen < h->count)
+            fprintf(out, "%12llu %14.12f %12llu %16.2f\n",
+                (unsigned long long)value, fraction, (unsigned long long)seen, 1.0 / (1.0 - fraction));
+        else
+            fprintf(out, "%12llu %14.12f %12llu %16s\n",
+                (unsigned long long)value, fraction, (unsigned long long)seen, "inf");
+    }
+}
@@ -0,0 +1,45 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifndef GTSTATS_H
+#define GTSTATS_H
+
+/*
+    Per-episode latency statistics shared by the omp, mpi and combined
+    harnesses.
+
+    Timestamps come from CLOCK_MONOTONIC_RAW, which NTP cannot slew.
+    Latencies are kept in an HDR-style log-linear histogram: values below
+    32 ns are exact, above that every power of two is split into 16
+    sub-buckets, so any reported value is within 1/16 (6.25%) of the
+    recorded one. Histograms merge by adding buckets, which is how the
+    per-thread and per-rank samples are combined.
+*/
+#define GTSTATS_SUB_BUCKET_BITS 4
+#define GTSTATS_SUB_BUCKETS (1 << GTSTATS_SUB_BUCKET_BITS)
+#define GTSTATS_BUCKETS ((64 - GTSTATS_SUB_BUCKET_BITS) * GTSTATS_SUB_BUCKETS + GTSTATS_SUB_BUCKETS)
+
+typedef struct{
+    uint64_t count;
+    uint64_t min;
+    uint64_t max;
+    double sum;
+    uint64_t buckets[GTSTATS_BUCKETS];
+} gtstats_hist_t;
+
+static inline uint64_t gtstats_now(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void gtstats_hist_init(gtstats_hist_t *h);
+void gtstats_hist_record(gtstats_hist_t *h, uint64_t value);
+void gtstats_hist_merge(gtstats_hist_t *dst, const gtstats_hist_t *src);
+uint64_t gtstats_hist_percentile(const gtstats_hist_t *h, double percentile);
+
+// one summary line; detail != 0 adds the HDR percentile distribution
+void gtstats_hist_report(FILE *out, const char *label, const gtstats_hist_t *h, int detail);
+
+#endif
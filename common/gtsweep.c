@@ -0,0 +1,124 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "gtsweep.h"
+
+void gtsweep_steady_init(gtsweep_steady_t *s){
+    s->batches = 0;
+    s->stable = 0;
+    s->last = 0;
+}
+
+int gtsweep_steady_add(gtsweep_steady_t *s, double batch_mean){
+    if (s->batches > 0 && s->last > 0 && fabs(batch_mean - s->last) / s->last < GTSWEEP_TOLERANCE)
+        s->stable++;
+    else
+        s->stable = 0;
+    s->last = batch_mean;
+    s->batches++;
+    return s->stable >= GTSWEEP_STABLE_BATCHES;
+}
+
+int gtsweep_steady_done(const gtsweep_steady_t *s){
+    return s->stable >= GTSWEEP_STABLE_BATCHES || s->batches >= GTSWEEP_MAX_WARMUP;
+}
+
+// two-sided 97.5% quantile of Student's t for df degrees of freedom
+static double t975(int df){
+    static const double table[] = {
+        0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (df < 1)
+        return 0;
+    return df <= 30 ? table[df] : 1.960;
+}
+
+gtsweep_summary_t gtsweep_summarize(const double *samples, int n){
+    gtsweep_summary_t s = { 0, 0, 0 };
+    double squares = 0;
+
+    if (n == 0)
+        return s;
+    for (int i = 0; i < n; i++)
+        s.mean += samples[i];
+    s.mean /= n;
+    for (int i = 0; i < n; i++)
+        squares += (samples[i] - s.mean) * (samples[i] - s.mean);
+    if (n > 1)
+    {
+        s.stddev = sqrt(squares / (n - 1));
+        s.ci95 = t975(n - 1) * s.stddev / sqrt(n);
+    }
+    return s;
+}
+
+int gtsweep_parse_list(const char *text, int *values, int max){
+    char *copy = strdup(text), *save, *end;
+    int n = 0;
+
+    for (char *item = strtok_r(copy, ",", &save); item != NULL; item = strtok_r(NULL, ",", &save))
+    {
+        long first = strtol(item, &end, 10), last = first;
+        if (*end == '-')
+            last = strtol(end + 1, &end, 10);
+        if (end == item || *end != '\0' || first < 0 || last < first)
+        {
+            free(copy);
+            return 0;
+        }
+        for (long v = first; v <= last && n < max; v++)
+            values[n++] = v;
+    }
+    free(copy);
+    return n;
+}
+
+int gtsweep_open(gtsweep_out_t *out, const char *path, const char *format){
+    out->json = format != NULL && strcmp(format, "json") == 0;
+    out->rows = 0;
+    out->out = path == NULL || strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (out->out == NULL)
+        return 0;
+
+    if (out->json)
+        fprintf(out->out, "[\n");
+    else
+        fprintf(out->out, "driver,algorithm,P,workload,reps,episodes,warmup_batches,steady,"
+            "barrier_ns,barrier_ci95,barrier_stddev,episode_ns,episode_ci95,p50_ns,p99_ns\n");
+    return 1;
+}
+
+void gtsweep_write(gtsweep_out_t *out, const gtsweep_row_t *row){
+    if (out->json)
+    {
+        fprintf(out->out, "%s  {\"driver\": \"%s\", \"algorithm\": \"%s\", \"P\": %d, \"workload\": \"%s\", "
+            "\"reps\": %d, \"episodes\": %d, \"warmup_batches\": %d, \"steady\": %s, "
+            "\"barrier_ns\": %.1f, \"barrier_ci95\": %.1f, \"barrier_stddev\": %.1f, "
+            "\"episode_ns\": %.1f, \"episode_ci95\": %.1f, \"p50_ns\": %llu, \"p99_ns\": %llu}",
+            out->rows ? ",\n" : "", row->driver, row->algorithm, row->P, row->workload,
+            row->reps, row->episodes, row->warmup_batches, row->steady ? "true" : "false",
+            row->barrier_ns.mean, row->barrier_ns.ci95, row->barrier_ns.stddev,
+            row->episode_ns.mean, row->episode_ns.ci95,
+            (unsigned long long)row->p50_ns, (unsigned long long)row->p99_ns);
+    }
+    else
+    {
+        fprintf(out->out, "%s,%s,%d,%s,%d,%d,%d,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%llu,%llu\n",
+            row->driver, row->algorithm, row->P, row->workload,
+            row->reps, row->episodes, row->warmup_batches, row->steady,
+            row->barrier_ns.mean, row->barrier_ns.ci95, row->barrier_ns.stddev,
+            row->episode_ns.mean, row->episode_ns.ci95,
+            (unsigned long long)row->p50_ns, (unsigned long long)row->p99_ns);
+    }
+    fflush(out->out); // a killed job still leaves the finished points
+    out->rows++;
+}
+
+void gtsweep_close(gtsweep_out_t *out){
+    if (out->json)
+        fprintf(out->out, "\n]\n");
+    if (out->out != stdout)
+        fclose(out->out);
+}
@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <stdint.h>
+
+#ifndef GTSWEEP_H
+#define GTSWEEP_H
+
+/*
+    Shared pieces of the in-process sweep drivers (omp/gtmp_sweep.c,
+    mpi/gtmpi_sweep.c). A sweep runs every (P, algorithm, workload) point
+    in one process:
+        warm-up     batches of as many episodes as a repetition, until
+                    GTSWEEP_STABLE_BATCHES consecutive batch means differ by
+                    less than GTSWEEP_TOLERANCE, at most GTSWEEP_MAX_WARMUP
+                    batches (the row then says steady=0)
+        measure     reps repetitions of episodes episodes each; every
+                    repetition yields one mean, and the row reports the mean
+                    of those with a 95% Student-t confidence interval
+    Rows go to a CSV or JSON file (or stdout), one per point.
+*/
+#define GTSWEEP_STABLE_BATCHES 3
+#define GTSWEEP_TOLERANCE 0.05
+#define GTSWEEP_MAX_WARMUP 50
+#define GTSWEEP_MAX_LIST 256
+
+typedef struct{
+    int batches;
+    int stable;   // consecutive batches within tolerance
+    double last;  // previous batch mean
+} gtsweep_steady_t;
+
+void gtsweep_steady_init(gtsweep_steady_t *s);
+int gtsweep_steady_add(gtsweep_steady_t *s, double batch_mean); // 1 once steady
+int gtsweep_steady_done(const gtsweep_steady_t *s);             // steady or out of batches
+
+typedef struct{
+    double mean;
+    double ci95;  // half-width
+    double stddev;
+} gtsweep_summary_t;
+
+gtsweep_summary_t gtsweep_summarize(const double *samples, int n);
+
+// "2,4,8" or "2-12" or a mix ("1,2-4,8"); returns the count, 0 on a parse error
+int gtsweep_parse_list(const char *text, int *values, int max);
+
+typedef struct{
+    const char *driver;     // "omp" or "mpi"
+    const char *algorithm;
+    int P;
+    const char *workload;   // gtwork spec of the compute between barriers
+    int reps;
+    int episodes;           // per repetition
+    int warmup_batches;
+    int steady;
+    gtsweep_summary_t barrier_ns; // arrival to release, mean over participants
+    gtsweep_summary_t episode_ns; // wall time per episode, work included
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+} gtsweep_row_t;
+
+typedef struct{
+    FILE *out;
+    int json;
+    int rows;
+} gtsweep_out_t;
+
+// path NULL or "-" is stdout; format "csv" or "json"
+int gtsweep_open(gtsweep_out_t *out, const char *path, const char *format);
+void gtsweep_write(gtsweep_out_t *out, const gtsweep_row_t *row);
+void gtsweep_close(gtsweep_out_t *out);
+
+#endif
@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include "gttune.h"
+
+static void cache_path(char *path, size_t size){
+    char *override = getenv("GT_TUNE_CACHE");
+    char *home = getenv("HOME");
+
+    if (override != NULL)
+        snprintf(path, size, "%s", override);
+    else
+        snprintf(path, size, "%s/.gt_tune", home != NULL ? home : ".");
+}
+
+void gttune_key(char *key, size_t size, const char *host, const char *family, int P, const char *topology){
+    snprintf(key, size, "%s/%s/P=%d/%s", host, family, P, topology);
+}
+
+int gttune_lookup(const char *key, char *algo, size_t size){
+    char path[512], line[GTTUNE_KEY_MAX + GTTUNE_NAME_MAX + 8];
+    char line_key[GTTUNE_KEY_MAX], line_algo[GTTUNE_NAME_MAX];
+    int found = 0;
+
+    cache_path(path, sizeof(path));
+    FILE *cache = fopen(path, "r");
+    if (cache == NULL)
+        return 0;
+
+    while (fgets(line, sizeof(line), cache) != NULL)
+    {
+        if (sscanf(line, "%255s %31s", line_key, line_algo) == 2 && strcmp(line_key, key) == 0)
+        {
+            snprintf(algo, size, "%s", line_algo);
+            found = 1; // keep reading: the newest entry wins
+        }
+    }
+    fclose(cache);
+    return found;
+}
+
+void gttune_store(const char *key, const char *algo){
+    char path[512];
+
+    cache_path(path, sizeof(path));
+    FILE *cache = fopen(path, "a");
+    if (cache == NULL)
+        return; // read-only home: tune again next run
+    fprintf(cache, "%s %s\n", key, algo);
+    fclose(cache);
+}
+
+void gttune_local_topology(char *topology, size_t size){
+    int numa = 0;
+    DIR *nodes = opendir("/sys/devices/system/node");
+
+    if (nodes != NULL)
+    {
+        struct dirent *entry;
+        while ((entry = readdir(nodes)) != NULL)
+        {
+            if (strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9')
+                numa++;
+        }
+        closedir(nodes);
+    }
+    snprintf(topology, size, "cpus=%ld,numa=%d", sysconf(_SC_NPROCESSORS_ONLN), numa > 0 ? numa : 1);
+}
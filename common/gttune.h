@@ -0,0 +1,24 @@
+#include <stddef.h>
+
+#ifndef GTTUNE_H
+#define GTTUNE_H
+
+/*
+    Cache of autotuner decisions, one "key algorithm" line per entry.
+
+    The file is $GT_TUNE_CACHE if set, else ~/.gt_tune. Keys are built by
+    gttune_key() from the host name, the barrier family, the team size and
+    a caller-supplied topology string, so heterogeneous partitions keep
+    separate entries. Later lines win, so re-tuning just appends.
+*/
+#define GTTUNE_KEY_MAX 256
+#define GTTUNE_NAME_MAX 32
+
+void gttune_key(char *key, size_t size, const char *host, const char *family, int P, const char *topology);
+int gttune_lookup(const char *key, char *algo, size_t size); // 1 if found
+void gttune_store(const char *key, const char *algo);
+
+// shared-memory topology of this machine: "cpus=<online>,numa=<nodes>"
+void gttune_local_topology(char *topology, size_t size);
+
+#endif
@@ -0,0 +1,161 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "gtwork.h"
+#include "gtstats.h"
+
+static uint64_t splitmix64(uint64_t x){
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// uniform in (0, 1), stream k of (thread, episode)
+static double draw(const gtwork_t *work, int thread, uint64_t episode, int k){
+    uint64_t x = splitmix64(work->seed ^ splitmix64(((uint64_t)thread << 40) ^ (episode << 2) ^ k));
+    return ((x >> 11) + 0.5) / 9007199254740992.0; // 53 bits
+}
+
+int gtwork_parse(gtwork_t *work, const char *spec){
+    char kind[16];
+    double a = 0, b = 0, c = 0;
+    char *seed = getenv("GT_WORK_SEED");
+    char *end;
+
+    memset(work, 0, sizeof(*work));
+    snprintf(work->spec, sizeof(work->spec), "%s", spec);
+    work->seed = seed != NULL ? strtoull(seed, NULL, 10) : 1;
+
+    a = strtod(spec, &end);
+    if (end != spec && *end == '\0') // bare number
+    {
+        work->kind = gtwork_spin_kind;
+        work->mean = a;
+        return a >= 0;
+    }
+
+    int fields = sscanf(spec, "%15[a-z]:%lf:%lf:%lf", kind, &a, &b, &c);
+    if (fields < 2 || a < 0)
+        return 0;
+    work->mean = a;
+    work->param = b;
+    if (strcmp(kind, "spin") == 0 && fields == 2)
+        work->kind = gtwork_spin_kind;
+    else if (strcmp(kind, "uniform") == 0 && fields == 3 && b >= 0 && b <= 1)
+        work->kind = gtwork_uniform;
+    else if (strcmp(kind, "gauss") == 0 && fields == 3 && b >= 0)
+        work->kind = gtwork_gauss;
+    else if (strcmp(kind, "pareto") == 0 && fields == 3 && b > 1)
+        work->kind = gtwork_pareto;
+    else if (strcmp(kind, "straggler") == 0 && fields == 4 && b >= 0 && c >= 1)
+    {
+        work->kind = gtwork_straggler;
+        work->period = c;
+    }
+    else
+        return 0;
+    return 1;
+}
+
+uint64_t gtwork_ns(const gtwork_t *work, int thread, int P, uint64_t episode){
+    double ns = work->mean;
+
+    switch (work->kind)
+    {
+        case gtwork_spin_kind:
+            break;
+        case gtwork_uniform:
+            ns = work->mean * (1 + work->param * (2 * draw(work, thread, episode, 0) - 1));
+            break;
+        case gtwork_gauss:
+        {
+            // Box-Muller
+            double u1 = draw(work, thread, episode, 0), u2 = draw(work, thread, episode, 1);
+            ns = work->mean + work->param * work->mean * sqrt(-2 * log(u1)) * cos(2 * M_PI * u2);
+            break;
+        }
+        case gtwork_pareto:
+        {
+            double scale = work->mean * (work->param - 1) / work->param; // so the mean is work->mean
+            ns = scale / pow(draw(work, thread, episode, 0), 1 / work->param);
+            if (ns > GTWORK_PARETO_CAP * work->mean)
+                ns = GTWORK_PARETO_CAP * work->mean;
+            break;
+        }
+        case gtwork_straggler:
+            if (episode % work->period == 0 && (int)(episode / work->period % P) == thread)
+                ns += work->param;
+            break;
+    }
+    return ns > 0 ? (uint64_t)ns : 0;
+}
+
+void gtwork_spin(uint64_t ns){
+    if (ns == 0)
+        return;
+    uint64_t end = gtstats_now() + ns;
+    while (gtstats_now() < end);
+}
+
+void gtwork_run(const gtwork_t *work, int thread, int P, uint64_t episode){
+    gtwork_spin(gtwork_ns(work, thread, P, episode));
+}
+
+int gtwork_from_env(gtwork_t *work){
+    char *spec = getenv("GT_WORK");
+
+    if (spec == NULL)
+        return 0;
+    if (!gtwork_parse(work, spec))
+    {
+        fprintf(stderr, "GT_WORK=%s is not a workload (see gtwork.h)\n", spec);
+        exit(EXIT_FAILURE);
+    }
+    return 1;
+}
+
+void gtwork_ftq(uint64_t quantum_ns, int samples, gtwork_ftq_t *result){
+    volatile uint64_t sink = 0;
+
+    result->samples = samples;
+    result->mean = 0;
+    result->min = 0;
+    result->max = 0;
+    for (int s = 0; s < samples; s++)
+    {
+        uint64_t end = gtstats_now() + quantum_ns;
+        double units = 0;
+        while (gtstats_now() < end) // one unit: a short fixed loop plus the clock read
+        {
+            for (int k = 0; k < 32; k++)
+                sink += k;
+            units++;
+        }
+        result->mean += units / samples;
+        if (s == 0 || units < result->min)
+            result->min = units;
+        if (units > result->max)
+            result->max = units;
+    }
+}
+
+void gtwork_ftq_merge(gtwork_ftq_t *dst, const gtwork_ftq_t *src){
+    if (dst->samples == 0)
+    {
+        *dst = *src;
+        return;
+    }
+    dst->mean = (dst->mean * dst->samples + src->mean * src->samples) / (dst->samples + src->samples);
+    dst->samples += src->samples;
+    if (src->min < dst->min)
+        dst->min = src->min;
+    if (src->max > dst->max)
+        dst->max = src->max;
+}
+
+void gtwork_ftq_report(FILE *out, const char *label, uint64_t quantum_ns, const gtwork_ftq_t *result){
+    double noise = result->max > 0 ? 1 - result->mean / result->max : 0;
+    fprintf(out, "%s (FTQ, %d quanta of %llu ns): work per quantum mean %.1f | min %.0f | max %.0f | noise %.2f%%\n",
+        label, result->samples, (unsigned long long)quantum_ns, result->mean, result->min, result->max, 100 * noise);
+}
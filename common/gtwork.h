@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include <stdint.h>
+
+#ifndef GTWORK_H
+#define GTWORK_H
+
+/*
+    Synthetic work between barriers, so arrivals are skewed the way a real
+    step is. A workload is parsed from a spec (times in ns):
+        spin:<ns>                           the same compute on every thread
+        uniform:<mean>:<spread>             mean * (1 +- spread), uniform
+        gauss:<mean>:<cv>                   normal, stddev = cv * mean, >= 0
+        pareto:<mean>:<alpha>               heavy-tailed (alpha > 1), capped
+                                            at GTWORK_PARETO_CAP * mean
+        straggler:<base>:<extra>:<period>   base everywhere; every period-th
+                                            episode one thread (rotating)
+                                            does base + extra
+    A bare number is spin:<number>. The draw for (thread, episode) comes
+    from a counter-based hash of GT_WORK_SEED (default 1), the thread and
+    the episode, so every barrier sees exactly the same imbalance.
+
+    The harnesses take the spec from GT_WORK, the sweep drivers from -w.
+
+    gtwork_ftq runs a fixed-time-quantum noise probe: count how many work
+    units fit into each of samples quanta. On a quiet core every quantum
+    holds the same count; interrupts, daemons and the scheduler show up as
+    dips, and noise is the fraction of the best quantum they take.
+    The harnesses run it on every thread first when GT_FTQ=<quantum_ns>.
+*/
+#define GTWORK_SPEC_MAX 64
+#define GTWORK_PARETO_CAP 100
+#define GTWORK_FTQ_SAMPLES 1000
+
+enum gtwork_kind{gtwork_spin_kind, gtwork_uniform, gtwork_gauss, gtwork_pareto, gtwork_straggler};
+
+typedef struct{
+    enum gtwork_kind kind;
+    double mean;      // ns; base for straggler
+    double param;     // spread, cv, alpha or straggler extra
+    int period;       // straggler
+    uint64_t seed;
+    char spec[GTWORK_SPEC_MAX];
+} gtwork_t;
+
+int gtwork_parse(gtwork_t *work, const char *spec); // 0 if the spec is malformed
+uint64_t gtwork_ns(const gtwork_t *work, int thread, int P, uint64_t episode);
+void gtwork_run(const gtwork_t *work, int thread, int P, uint64_t episode);
+void gtwork_spin(uint64_t ns);
+
+// from GT_WORK: 1 and *work filled if set, 0 (no work) if not; exits on a bad spec
+int gtwork_from_env(gtwork_t *work);
+
+typedef struct{
+    int samples;
+    double mean;    // work units per quantum
+    double min;
+    double max;
+} gtwork_ftq_t;
+
+void gtwork_ftq(uint64_t quantum_ns, int samples, gtwork_ftq_t *result);
+void gtwork_ftq_merge(gtwork_ftq_t *dst, const gtwork_ftq_t *src); // dst may be empty (samples 0)
+void gtwork_ftq_report(FILE *out, const char *label, uint64_t quantum_ns, const gtwork_ftq_t *result);
+
+#endif
@@ -4,6 +4,21 @@
 #ifndef GTMPI_H
 #define GTMPI_H
 
+/*
+    Every implementation defines gtmpi_init/gtmpi_barrier/gtmpi_finalize,
+    and the Makefile links exactly one of them per binary. The autotuned
+    build (mpi_auto) links all of them instead. Each one is compiled with
+    -DGTMPI_ALGO=<name>, so its entry points become <name>_init,
+    <name>_barrier and <name>_finalize (see gtmpi_algos.h).
+*/
+#ifdef GTMPI_ALGO
+#define GTMPI_PASTE(algo, fn) algo##fn
+#define GTMPI_NAME(algo, fn) GTMPI_PASTE(algo, fn)
+#define gtmpi_init GTMPI_NAME(GTMPI_ALGO, _init)
+#define gtmpi_barrier GTMPI_NAME(GTMPI_ALGO, _barrier)
+#define gtmpi_finalize GTMPI_NAME(GTMPI_ALGO, _finalize)
+#endif
+
 enum Role{winner=1, loser=2, bye=3, champion=4, dropout=5};
 
 typedef struct{
@@ -12,6 +27,16 @@ typedef struct{
     bool flag;
 } round_t;
 
+/*
+    Communicator the barriers run on: MPI_COMM_WORLD, unless a driver runs
+    them on a subset of the ranks (gtmpi_sweep.c). The harness or driver
+    defines it. Only visible after mpi.h, so the simulator can include
+    this header without MPI.
+*/
+#ifdef MPI_VERSION
+extern MPI_Comm gtmpi_comm;
+#endif
+
 extern round_t **rounds;
 extern int vpid;
 extern bool sense;
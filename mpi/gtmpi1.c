@@ -19,39 +19,59 @@
             repeat until sense = local_sense
 */
 
-static int counter;
-static int shared_sense;
-int world_size;
+/*
+    Message-passing version: rank 0 holds count and sense. Every other rank
+    sends its arrival to rank 0 (the fetch_and_decrement) and blocks until
+    rank 0 sends the new sense back (the spin). Rank 0 counts the arrivals,
+    resets count, flips sense and sends it to every rank. A rank leaves
+    only once the sense it receives matches its local sense, so no rank can
+    leave an episode before all have arrived.
+*/
+#define SENSE_TAG 0
+
+static int count;        // rank 0: arrivals still missing this episode
+static int shared_sense; // rank 0's copy of sense
+static int local_sense;
+static int world_size;
+static int rank;
 
 void gtmpi_init(int num_processes){
-    int rank = 0;
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    counter = 1;
-    shared_sense = 0;
-    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(gtmpi_comm, &rank);
+    MPI_Comm_size(gtmpi_comm, &world_size);
+    count = world_size;
+    shared_sense = 1;
+    local_sense = 1;
 }
 
 void gtmpi_barrier(){
-    int rank, local_sense;
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-
-    local_sense = !shared_sense;
+    local_sense = !local_sense; // each process toggles its own sense
 
-    // Simulate fetch_and_increment with MPI_Allreduce to sum all the counters
-    int local_count = 1;  // Each process adds 1 to the counter
-    int total_count;
-
-    MPI_Allreduce(&local_count, &total_count, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
-    
-    if (total_count == world_size)
+    if (rank == 0)
+    {
+        int arrival;
+        count--; // rank 0's own arrival
+        while (count > 0)
+        {
+            MPI_Recv(&arrival, 1, MPI_INT, MPI_ANY_SOURCE, SENSE_TAG, gtmpi_comm, MPI_STATUS_IGNORE);
+            count--;
+        }
+        count = world_size;
+        shared_sense = local_sense; // last arrival toggles the global sense
+        for (int i = 1; i < world_size; i++)
+        {
+            MPI_Send(&shared_sense, 1, MPI_INT, i, SENSE_TAG, gtmpi_comm);
+        }
+    }
+    else
     {
-        // if all processes have reached barrier, reset counter and flip sense flag
-        counter = 1;
-        shared_sense = local_sense;
-    } else {
-        while(shared_sense != local_sense);
+        int sense_seen = !local_sense;
+        MPI_Send(&local_sense, 1, MPI_INT, 0, SENSE_TAG, gtmpi_comm);
+        while (sense_seen != local_sense) // repeat until sense = local_sense
+        {
+            MPI_Recv(&sense_seen, 1, MPI_INT, 0, SENSE_TAG, gtmpi_comm, MPI_STATUS_IGNORE);
+        }
     }
 }
 
 void gtmpi_finalize(){
-}
\ No newline at end of file
+}
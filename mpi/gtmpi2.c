@@ -2,6 +2,7 @@
 #include <mpi.h>
 #include <stdio.h>
 #include "gtmpi.h"
+#include "gtmpi_schedule.h"
 /*
     From the MCS Paper: A scalable, distributed tournament barrier with only local spinning.
     
@@ -74,93 +75,42 @@ void gtmpi_init(int num_processes){
     init basic info
     =============================================================*/
     P = num_processes;
-    num_rounds = ceil(log2(P));
-    MPI_Comm_rank(MPI_COMM_WORLD, &vpid);
+    MPI_Comm_rank(gtmpi_comm, &vpid);
     sense = true;
 
     /*=============================================================
-    init rounds[vpid][round]
+    statically decide its role & its opponent (gtmpi_schedule.c)
     =============================================================*/
-    rounds = (round_t **)calloc(P, sizeof(round_t *));
-    for(int i=0; i< P; i++){
-        rounds[i] = (round_t *)calloc(num_rounds+1, sizeof(round_t));
-    }
-
-    /*=============================================================
-    statically decide its role & its opponent
-    =============================================================*/
-    for(int i=0; i<P; i++){
-        for(int k=0; k<num_rounds+1; k++){
-            // init flag to false;
-            rounds[i][k].flag = false;
-
-            // init role;
-            if(k > 0){ 
-                if(i % (int)pow(2,k) == 0){ // bye or winner
-                    if( (i + (int)pow(2,k-1) < P) && ((int)pow(2,k) < P)){ //  && not last round
-                        rounds[i][k].role = winner;
-                    } else if(i + (int)pow(2,k-1) >= P){ // not available in this round // !review again
-                        rounds[i][k].role = bye;
-                    }
-                } 
-
-                if(i % (int)pow(2,k) == (int)pow(2,k-1)){ // loser
-                    rounds[i][k].role = loser;
-                }
-                
-                if( (i == 0) && ((int)pow(2,k) >= P) ){ // champion when root proc && when last round
-                    rounds[i][k].role = champion;
-                }
-            }else if(k==0){ // dropout
-                rounds[i][k].role = dropout;
-            }
-
-            // init opponent;
-            switch(rounds[i][k].role)
-            {
-                case loser: // loser point to its winner
-                    rounds[i][k].opponent = i - (int)pow(2,k-1); // opponent to MPI_Send
-                    break;
-                case winner: // winner and champion point to its loser
-                case champion: 
-                    rounds[i][k].opponent = i + (int)pow(2,k-1);
-                    break;        
-                case dropout: // not needed
-                    rounds[i][k].opponent = -1;
-                    break;
-                case bye: // not needed
-                    rounds[i][k].opponent = -1;
-                    break;
-            }
-        }
-    }
-
+    rounds = gtmpi_tournament_schedule(P, &num_rounds);
 }
 
-void gtmpi_barrier(){ // MPI_Barrier(MPI_COMM_WORLD);
+void gtmpi_barrier(){ // MPI_Barrier(gtmpi_comm);
     int round = 1; // first round
     int exit_arrival = 1;
 
+    if(num_rounds == 0) // single process: rounds[0] has no round 1
+        return;
+
     // arrival loop
     while(exit_arrival){
         switch(rounds[vpid][round].role)
         {
             case loser:
                 MPI_Send(                
-                    &sense, 1, MPI_C_BOOL, rounds[vpid][round].opponent, 0, MPI_COMM_WORLD);
+                    &sense, 1, MPI_C_BOOL, rounds[vpid][round].opponent, 0, gtmpi_comm);
                 MPI_Recv( 
-                    &rounds[vpid][round].flag, 1, MPI_C_BOOL, rounds[vpid][round].opponent, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                    &rounds[vpid][round].flag, 1, MPI_C_BOOL, rounds[vpid][round].opponent, 0, gtmpi_comm, MPI_STATUS_IGNORE);
                 exit_arrival = 0; //exit loop
                 break;
             case winner:
                 MPI_Recv( 
-                    &rounds[vpid][round].flag, 1, MPI_C_BOOL, rounds[vpid][round].opponent, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                    &rounds[vpid][round].flag, 1, MPI_C_BOOL, rounds[vpid][round].opponent, 0, gtmpi_comm, MPI_STATUS_IGNORE);
                 break; // no need exit_arrival because champion will do in the last round
             case champion:
                 MPI_Recv( 
-                    &rounds[vpid][round].flag, 1, MPI_C_BOOL, rounds[vpid][round].opponent, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                    &rounds[vpid][round].flag, 1, MPI_C_BOOL, rounds[vpid][round].opponent, 0, gtmpi_comm, MPI_STATUS_IGNORE);
                 MPI_Send(                
-                    &sense, 1, MPI_C_BOOL, rounds[vpid][round].opponent, 0, MPI_COMM_WORLD);
+                    &sense, 1, MPI_C_BOOL, rounds[vpid][round].opponent, 0, gtmpi_comm);
                 exit_arrival = 0; // exit loop
                 break;
             case bye: // do nothing
@@ -178,7 +128,7 @@ void gtmpi_barrier(){ // MPI_Barrier(MPI_COMM_WORLD);
         {
             case winner:
                 MPI_Send(               
-                    &sense, 1, MPI_C_BOOL, rounds[vpid][round].opponent, 0, MPI_COMM_WORLD);
+                    &sense, 1, MPI_C_BOOL, rounds[vpid][round].opponent, 0, gtmpi_comm);
                 break;
             case dropout:
                 exit_wakeup = 0; // exit loop when all round is done
@@ -194,7 +144,5 @@ void gtmpi_barrier(){ // MPI_Barrier(MPI_COMM_WORLD);
 }
 
 void gtmpi_finalize(){ 
-    for(int i=0; i< P; i++)
-        free(rounds[i]);
-    free(rounds);
+    gtmpi_free_schedule(rounds, P);
 }
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include <stdlib.h>
+#include <mpi.h>
+#include <stdio.h>
+#include "gtmpi.h"
+
+/*
+    Dissemination barrier over MPI neighborhood collectives
+
+    Round r of the dissemination barrier has every rank i signal rank
+    (i + 2^r) mod P and wait for rank (i - 2^r) mod P. gtmpi_init gives
+    each round its own distributed-graph communicator with exactly that
+    one in- and one out-neighbour (MPI_Dist_graph_create_adjacent), and a
+    round is an MPI_Neighbor_alltoall of one byte on it. The library sees
+    the whole round as one collective, so it can map and schedule it
+    itself instead of receiving separate sends and receives.
+
+    With MPI 4 every round is also a persistent request
+    (MPI_Neighbor_alltoall_init), set up once and only started and waited
+    on per episode. Older libraries (MPI_VERSION < 4) run the blocking
+    collective.
+*/
+#if MPI_VERSION >= 4
+#define GTMPI4_PERSISTENT 1
+#endif
+
+static int num_graph_rounds;
+static MPI_Comm *graphs;      // one per round
+#ifdef GTMPI4_PERSISTENT
+static MPI_Request *requests; // one per round
+#endif
+static char token_out = 1;
+static char token_in;
+
+void gtmpi_init(int num_processes){
+    int rank, size;
+    MPI_Comm_rank(gtmpi_comm, &rank);
+    MPI_Comm_size(gtmpi_comm, &size);
+
+    num_graph_rounds = 0; // ceil(log2(P)) rounds, none for P = 1
+    for (int reach = 1; reach < size; reach *= 2)
+    {
+        num_graph_rounds++;
+    }
+
+    graphs = (MPI_Comm*)malloc(num_graph_rounds * sizeof(MPI_Comm));
+#ifdef GTMPI4_PERSISTENT
+    requests = (MPI_Request*)malloc(num_graph_rounds * sizeof(MPI_Request));
+#endif
+    for (int r = 0, distance = 1; r < num_graph_rounds; r++, distance *= 2)
+    {
+        int to = (rank + distance) % size;
+        int from = (rank - distance % size + size) % size;
+        int weight = 1; // explicit: the MPI_UNWEIGHTED sentinel trips gcc's -Wstringop-overread
+        MPI_Dist_graph_create_adjacent(gtmpi_comm, 1, &from, &weight, 1, &to, &weight,
+                                       MPI_INFO_NULL, 0, &graphs[r]);
+#ifdef GTMPI4_PERSISTENT
+        MPI_Neighbor_alltoall_init(&token_out, 1, MPI_BYTE, &token_in, 1, MPI_BYTE, graphs[r],
+                                   MPI_INFO_NULL, &requests[r]);
+#endif
+    }
+}
+
+void gtmpi_barrier(){
+    for (int r = 0; r < num_graph_rounds; r++)
+    {
+#ifdef GTMPI4_PERSISTENT
+        MPI_Start(&requests[r]);
+        MPI_Wait(&requests[r], MPI_STATUS_IGNORE);
+#else
+        MPI_Neighbor_alltoall(&token_out, 1, MPI_BYTE, &token_in, 1, MPI_BYTE, graphs[r]);
+#endif
+    }
+}
+
+void gtmpi_finalize(){
+    for (int r = 0; r < num_graph_rounds; r++)
+    {
+#ifdef GTMPI4_PERSISTENT
+        MPI_Request_free(&requests[r]);
+#endif
+        MPI_Comm_free(&graphs[r]);
+    }
+    free(graphs);
+#ifdef GTMPI4_PERSISTENT
+    free(requests);
+#endif
+}
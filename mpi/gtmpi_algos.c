@@ -0,0 +1,32 @@
+#include <string.h>
+#include "gtmpi_algos.h"
+
+#define DECLARE_ALGO(name) \
+    void name##_init(int num_processes); \
+    void name##_barrier(); \
+    void name##_finalize();
+
+DECLARE_ALGO(sense)      // gtmpi1.c
+DECLARE_ALGO(tournament) // gtmpi2.c
+DECLARE_ALGO(neighbor)   // gtmpi4.c
+DECLARE_ALGO(mpi)        // gtmpi_control.c
+
+#define ALGO(name) { #name, name##_init, name##_barrier, name##_finalize }
+
+const gtmpi_algo_t gtmpi_algos[] = {
+    ALGO(sense),
+    ALGO(tournament),
+    ALGO(neighbor),
+    ALGO(mpi),
+};
+
+const int gtmpi_num_algos = sizeof(gtmpi_algos) / sizeof(gtmpi_algos[0]);
+
+const gtmpi_algo_t *gtmpi_find_algo(const char *name){
+    for (int i = 0; i < gtmpi_num_algos; i++)
+    {
+        if (strcmp(gtmpi_algos[i].name, name) == 0)
+            return &gtmpi_algos[i];
+    }
+    return NULL;
+}
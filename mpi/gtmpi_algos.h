@@ -0,0 +1,20 @@
+#ifndef GTMPI_ALGOS_H
+#define GTMPI_ALGOS_H
+
+/*
+    Every MPI barrier linked into the all-algorithm build, under the
+    name its file was compiled with (-DGTMPI_ALGO=<name>, see gtmpi.h).
+*/
+typedef struct{
+    const char *name;
+    void (*init)(int num_processes);
+    void (*barrier)();
+    void (*finalize)();
+} gtmpi_algo_t;
+
+extern const gtmpi_algo_t gtmpi_algos[];
+extern const int gtmpi_num_algos;
+
+const gtmpi_algo_t *gtmpi_find_algo(const char *name);
+
+#endif
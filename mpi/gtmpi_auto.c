@@ -0,0 +1,127 @@
+#include <stdlib.h>
+#include <mpi.h>
+#include <stdio.h>
+#include "gtmpi.h"
+#include "gtmpi_algos.h"
+#include "gtstats.h"
+#include "gttune.h"
+
+/*
+    Autotuned barrier (mpi_auto)
+
+    gtmpi_init picks one of gtmpi_algos[] for the job and forwards
+    gtmpi_barrier/gtmpi_finalize to it. Rank 0 makes the decision and
+    broadcasts it, so every rank dispatches to the same algorithm:
+        1. GTMPI_BARRIER=<name> forces an algorithm
+        2. a cached decision for (host of rank 0, P, topology), see gttune.h;
+           topology is the number of nodes and ranks per node
+        3. a short calibration: each algorithm runs CALIBRATION_EPISODES
+           episodes after a warm-up, the slowest rank's mean counts, and
+           the lowest wins and is added to the cache
+    The decision is kept for the process, so the harness re-initializing
+    the barrier for every experiment does not re-tune.
+*/
+#define WARMUP_EPISODES 50
+#define CALIBRATION_EPISODES 500
+
+static const gtmpi_algo_t *current;
+static int tuned_P = -1;
+
+static double calibrate(const gtmpi_algo_t *algo, int num_processes){
+    double ns, slowest;
+
+    algo->init(num_processes);
+    for (int i = 0; i < WARMUP_EPISODES; i++)
+    {
+        algo->barrier();
+    }
+    uint64_t start = gtstats_now();
+    for (int i = 0; i < CALIBRATION_EPISODES; i++)
+    {
+        algo->barrier();
+    }
+    ns = (double)(gtstats_now() - start) / CALIBRATION_EPISODES;
+    algo->finalize();
+
+    MPI_Allreduce(&ns, &slowest, 1, MPI_DOUBLE, MPI_MAX, gtmpi_comm);
+    return slowest;
+}
+
+static void job_topology(char *topology, size_t size){
+    MPI_Comm node;
+    int local_rank, local_size, leader, nodes, ppn;
+
+    MPI_Comm_split_type(gtmpi_comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node);
+    MPI_Comm_rank(node, &local_rank);
+    MPI_Comm_size(node, &local_size);
+    MPI_Comm_free(&node);
+
+    leader = local_rank == 0;
+    MPI_Allreduce(&leader, &nodes, 1, MPI_INT, MPI_SUM, gtmpi_comm);
+    MPI_Allreduce(&local_size, &ppn, 1, MPI_INT, MPI_MAX, gtmpi_comm);
+    snprintf(topology, size, "nodes=%d,ppn=%d", nodes, ppn);
+}
+
+static const gtmpi_algo_t *choose(int num_processes){
+    char host[MPI_MAX_PROCESSOR_NAME], topology[64], key[GTTUNE_KEY_MAX], name[GTTUNE_NAME_MAX];
+    int rank, host_len, index = -1;
+
+    MPI_Comm_rank(gtmpi_comm, &rank);
+    if (num_processes == 1)
+        return gtmpi_find_algo("mpi"); // nothing to tune
+
+    job_topology(topology, sizeof(topology));
+    MPI_Get_processor_name(host, &host_len);
+    gttune_key(key, sizeof(key), host, "mpi", num_processes, topology);
+
+    if (rank == 0)
+    {
+        char *forced = getenv("GTMPI_BARRIER");
+        const gtmpi_algo_t *algo = NULL;
+
+        if (forced != NULL && (algo = gtmpi_find_algo(forced)) == NULL)
+            fprintf(stderr, "GTMPI_BARRIER=%s is not a known barrier, tuning instead\n", forced);
+        if (algo == NULL && gttune_lookup(key, name, sizeof(name)))
+            algo = gtmpi_find_algo(name);
+        if (algo != NULL)
+            index = algo - gtmpi_algos;
+    }
+    MPI_Bcast(&index, 1, MPI_INT, 0, gtmpi_comm);
+    if (index >= 0)
+        return &gtmpi_algos[index];
+
+    double best_ns = 0;
+    for (int i = 0; i < gtmpi_num_algos; i++)
+    {
+        double ns = calibrate(&gtmpi_algos[i], num_processes); // same value on every rank
+        if (index < 0 || ns < best_ns)
+        {
+            index = i;
+            best_ns = ns;
+        }
+    }
+    if (rank == 0)
+        gttune_store(key, gtmpi_algos[index].name);
+    return &gtmpi_algos[index];
+}
+
+void gtmpi_init(int num_processes){
+    if (current == NULL || tuned_P != num_processes)
+    {
+        int rank;
+        MPI_Comm_rank(gtmpi_comm, &rank);
+        current = choose(num_processes);
+        tuned_P = num_processes;
+        if (rank == 0)
+            printf("gtmpi_auto: %d processes -> %s barrier\n", num_processes, current->name);
+    }
+    current->init(num_processes);
+}
+
+void gtmpi_barrier(){
+    current->barrier();
+}
+
+void gtmpi_finalize(){
+    current->finalize();
+}
@@ -0,0 +1,255 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <mpi.h>
+#include "gtmpi.h"
+#include "gtmpi_algos.h"
+#include "gtcheck.h"
+#include "gtstats.h"
+
+/*
+    Stress and regression check for every MPI barrier in gtmpi_algos[]
+    (mpi_check, run by make check). See gtcheck.h.
+
+    Launch it once with the largest process count; like mpi_sweep, a team
+    of P < N runs on a communicator of ranks 0..P-1 (gtmpi_comm) while
+    the other ranks wait. The per-episode arrival counters live in an RMA
+    window on the team's rank 0: every rank adds one with MPI_Fetch_and_op
+    and flushes before it enters the barrier, and reads the counter back
+    after it leaves.
+
+    Usage: mpirun -np N ./mpi_check [-a algo,...] [-e episodes] [-w workload]
+                                    [-t teams] [-n episodes] [-b baseline] [-s slack] [-r]
+        -a          barriers (default every one in gtmpi_algos[])
+        -e -w       stress: teams of 1..N ranks, episodes each (default
+                    200, 0 skips it), delays from workload (default
+                    pareto:2000:1.5)
+        -t -n       regression: median over n episodes (default 1000) per
+                    run on each team of the list (default 4,8 ranks, none
+                    larger than N)
+        -b -s       baseline file (default check.baseline.<host>), slack (1.5,
+                    0 skips the regression)
+        -r          only measure, and print the baseline lines
+
+    make check runs the stress part on 64 ranks and the regression part in
+    a launch of its own per team, so that idle ranks add no noise.
+*/
+MPI_Comm gtmpi_comm = MPI_COMM_WORLD;
+
+static int world_rank;
+
+// episodes on the team in gtmpi_comm; returns the early departures this rank saw, *first the first such episode
+static int stress(const gtmpi_algo_t *algo, int P, int episodes, const gtwork_t *work, int *first){
+    int me, *counters = NULL, one = 1, arrived, early = 0;
+    MPI_Win win;
+
+    MPI_Comm_rank(gtmpi_comm, &me);
+    MPI_Win_allocate(me == 0 ? episodes * sizeof(int) : 0, sizeof(int), MPI_INFO_NULL, gtmpi_comm, &counters, &win);
+    if (me == 0)
+        memset(counters, 0, episodes * sizeof(int));
+    MPI_Barrier(gtmpi_comm); // counters zeroed before the first arrival
+    MPI_Win_lock_all(0, win);
+
+    algo->init(P);
+    for (int e = 0; e < episodes; e++)
+    {
+        gtcheck_delay(work, me, P, e);
+        MPI_Fetch_and_op(&one, &arrived, MPI_INT, 0, e, MPI_SUM, win);
+        MPI_Win_flush(0, win); // the arrival is at rank 0 before this rank enters
+        algo->barrier();
+        MPI_Fetch_and_op(NULL, &arrived, MPI_INT, 0, e, MPI_NO_OP, win);
+        MPI_Win_flush(0, win);
+        if (arrived != P && early++ == 0)
+            *first = e;
+    }
+    algo->finalize();
+
+    MPI_Win_unlock_all(win);
+    MPI_Win_free(&win);
+    return early;
+}
+
+// median episode latency over all ranks of gtmpi_comm, on its rank 0
+static double median_latency(const gtmpi_algo_t *algo, int P, int episodes){
+    gtstats_hist_t local, all;
+
+    gtstats_hist_init(&local);
+    gtstats_hist_init(&all);
+    algo->init(P);
+    for (int e = 0; e < episodes / 10; e++) // warm-up
+        algo->barrier();
+    for (int e = 0; e < episodes; e++)
+    {
+        uint64_t arrive = gtstats_now();
+        algo->barrier();
+        gtstats_hist_record(&local, gtstats_now() - arrive);
+    }
+    algo->finalize();
+
+    MPI_Reduce(local.buckets, all.buckets, GTSTATS_BUCKETS, MPI_UINT64_T, MPI_SUM, 0, gtmpi_comm);
+    MPI_Reduce(&local.count, &all.count, 1, MPI_UINT64_T, MPI_SUM, 0, gtmpi_comm);
+    MPI_Reduce(&local.min, &all.min, 1, MPI_UINT64_T, MPI_MIN, 0, gtmpi_comm);
+    MPI_Reduce(&local.max, &all.max, 1, MPI_UINT64_T, MPI_MAX, 0, gtmpi_comm);
+    return gtstats_hist_percentile(&all, 50);
+}
+
+static void fail(const char *message){
+    if (world_rank == 0)
+        fprintf(stderr, "mpi_check: %s\n", message);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv){
+    char default_baseline[512];
+    const char *baseline = default_baseline, *spec = GTCHECK_WORK;
+    const char *team_list = GTCHECK_TEAMS;
+    char *algos = NULL;
+    int episodes = 200, perf_episodes = 1000, record = 0, opt, world_size;
+    int teams[GTCHECK_TEAMS_MAX], n_teams;
+    double slack = GTCHECK_SLACK;
+    gtwork_t work;
+
+    gtcheck_baseline_path(default_baseline, sizeof(default_baseline));
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    while ((opt = getopt(argc, argv, "a:e:w:t:n:b:s:r")) != -1)
+    {
+        switch (opt)
+        {
+            case 'a': algos = optarg; break;
+            case 'e': episodes = strtol(optarg, NULL, 10); break;
+            case 'w': spec = optarg; break;
+            case 't': team_list = optarg; break;
+            case 'n': perf_episodes = strtol(optarg, NULL, 10); break;
+            case 'b': baseline = optarg; break;
+            case 's': slack = strtod(optarg, NULL); break;
+            case 'r': record = 1; break;
+            default:
+                fail("usage: mpi_check [-a algo,...] [-e episodes] [-w workload] [-t teams] [-n episodes] [-b baseline] [-s slack] [-r]");
+        }
+    }
+    n_teams = gtcheck_teams(team_list, teams);
+    if (episodes < 0 || perf_episodes < 10 || n_teams == 0 || slack < 0 || !gtwork_parse(&work, spec))
+        fail("bad -e, -t, -n, -s or -w");
+    for (int i = 0; (record || slack > 0) && i < n_teams; i++)
+    {
+        if (teams[i] > world_size)
+            fail("a -t team is larger than the launch; run with more ranks or -s 0");
+    }
+
+    const gtmpi_algo_t *selected[16];
+    int n_algos = 0;
+    if (algos == NULL)
+    {
+        for (int i = 0; i < gtmpi_num_algos; i++)
+            selected[n_algos++] = &gtmpi_algos[i];
+    }
+    else
+    {
+        char *copy = strdup(algos), *save;
+        for (char *name = strtok_r(copy, ",", &save); name != NULL; name = strtok_r(NULL, ",", &save))
+        {
+            if (n_algos == 16)
+                fail("too many algorithms in -a");
+            if ((selected[n_algos++] = gtmpi_find_algo(name)) == NULL)
+                fail("unknown algorithm in -a");
+        }
+        free(copy);
+    }
+
+    char team[GTCHECK_TEAM_MAX], what[128];
+    int failed = 0;
+
+    for (int a = 0; a < n_algos; a++)
+    {
+        const gtmpi_algo_t *algo = selected[a];
+        int early_total = 0, first_P = 0;
+        struct{ int episode; int rank; } first_local, first = { 0, 0 };
+
+        for (int P = 1; !record && episodes > 0 && P <= world_size; P++)
+        {
+            MPI_Comm sub;
+            int early = 0, episode = episodes;
+
+            snprintf(what, sizeof(what), "mpi_check: %s, stress on %d ranks (rank %d)", algo->name, P, world_rank);
+            gtcheck_watchdog(what, GTCHECK_TIMEOUT);
+            MPI_Comm_split(MPI_COMM_WORLD, world_rank < P ? 0 : MPI_UNDEFINED, world_rank, &sub);
+            if (sub != MPI_COMM_NULL)
+            {
+                gtmpi_comm = sub;
+                early = stress(algo, P, episodes, &work, &episode);
+                gtmpi_comm = MPI_COMM_WORLD;
+                MPI_Comm_free(&sub);
+            }
+
+            // the first team size with early departures, and its earliest one
+            int sum;
+            first_local.episode = early > 0 ? episode : episodes;
+            first_local.rank = world_rank;
+            MPI_Allreduce(&early, &sum, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+            if (sum > 0 && early_total == 0)
+            {
+                MPI_Allreduce(&first_local, &first, 1, MPI_2INT, MPI_MINLOC, MPI_COMM_WORLD);
+                first_P = P;
+            }
+            early_total += sum;
+        }
+        gtcheck_watchdog(NULL, 0);
+
+        if (!record && episodes > 0 && world_rank == 0)
+        {
+            if (early_total > 0)
+            {
+                printf("mpi_check: %s: stress 1-%d ranks x %d episodes (%s): FAILED, %d early departures;"
+                       " first on %d ranks, episode %d: rank %d left before everybody arrived\n",
+                    algo->name, world_size, episodes, work.spec, early_total, first_P, first.episode, first.rank);
+                failed = 1;
+            }
+            else
+                printf("mpi_check: %s: stress 1-%d ranks x %d episodes (%s): ok\n", algo->name, world_size, episodes, work.spec);
+        }
+
+        for (int i = 0; (record || slack > 0) && i < n_teams; i++)
+        {
+            int P = teams[i];
+            MPI_Comm sub;
+            double median = 0;
+
+            snprintf(what, sizeof(what), "mpi_check: %s, regression on %d ranks (rank %d)", algo->name, P, world_rank);
+            gtcheck_watchdog(what, GTCHECK_TIMEOUT);
+            MPI_Comm_split(MPI_COMM_WORLD, world_rank < P ? 0 : MPI_UNDEFINED, world_rank, &sub);
+            if (sub != MPI_COMM_NULL)
+            {
+                gtmpi_comm = sub;
+                median = median_latency(algo, P, perf_episodes);
+                for (int r = 1; r < GTCHECK_REPEATS; r++)
+                {
+                    double again = median_latency(algo, P, perf_episodes);
+                    if (again < median)
+                        median = again;
+                }
+                gtmpi_comm = MPI_COMM_WORLD;
+                MPI_Comm_free(&sub);
+            }
+            MPI_Barrier(MPI_COMM_WORLD); // idle ranks wait here
+            gtcheck_watchdog(NULL, 0);
+
+            snprintf(team, sizeof(team), "%d", P);
+            if (world_rank == 0)
+            {
+                if (record)
+                    gtcheck_record(stdout, algo->name, team, median);
+                else
+                    failed |= gtcheck_regression(stdout, baseline, algo->name, team, median, slack);
+            }
+        }
+    }
+
+    MPI_Bcast(&failed, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Finalize();
+    return failed;
+}
@@ -7,13 +7,13 @@
     Control barrier (OpenMPI)
 */
 
-int world_size;
+static int world_size; // size of gtmpi_comm
 void gtmpi_init(int num_processes){
-    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_size(gtmpi_comm, &world_size);
 }
 
 void gtmpi_barrier(){
-    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Barrier(gtmpi_comm);
 }
 
 void gtmpi_finalize(){
@@ -0,0 +1,80 @@
+#include <stdlib.h>
+#include "gtmpi_schedule.h"
+
+round_t **gtmpi_tournament_schedule(int num_processes, int *num_rounds){
+    int P = num_processes;
+    int R = ceil(log2(P));
+
+    /*=============================================================
+    init rounds[vpid][round]
+    =============================================================*/
+    round_t **rounds = (round_t **)calloc(P, sizeof(round_t *));
+    for(int i=0; i< P; i++){
+        rounds[i] = (round_t *)calloc(R+1, sizeof(round_t));
+    }
+
+    *num_rounds = gtmpi_fill_schedule(rounds, P);
+    return rounds;
+}
+
+int gtmpi_fill_schedule(round_t **rounds, int num_processes){
+    int P = num_processes;
+    int R = ceil(log2(P));
+
+    /*=============================================================
+    statically decide its role & its opponent
+    =============================================================*/
+    for(int i=0; i<P; i++){
+        for(int k=0; k<R+1; k++){
+            // init flag to false;
+            rounds[i][k].flag = false;
+
+            // init role;
+            if(k > 0){ 
+                if(i % (int)pow(2,k) == 0){ // bye or winner
+                    if( (i + (int)pow(2,k-1) < P) && ((int)pow(2,k) < P)){ //  && not last round
+                        rounds[i][k].role = winner;
+                    } else if(i + (int)pow(2,k-1) >= P){ // not available in this round // !review again
+                        rounds[i][k].role = bye;
+                    }
+                } 
+
+                if(i % (int)pow(2,k) == (int)pow(2,k-1)){ // loser
+                    rounds[i][k].role = loser;
+                }
+                
+                if( (i == 0) && ((int)pow(2,k) >= P) ){ // champion when root proc && when last round
+                    rounds[i][k].role = champion;
+                }
+            }else if(k==0){ // dropout
+                rounds[i][k].role = dropout;
+            }
+
+            // init opponent;
+            switch(rounds[i][k].role)
+            {
+                case loser: // loser point to its winner
+                    rounds[i][k].opponent = i - (int)pow(2,k-1); // opponent to MPI_Send
+                    break;
+                case winner: // winner and champion point to its loser
+                case champion: 
+                    rounds[i][k].opponent = i + (int)pow(2,k-1);
+                    break;        
+                case dropout: // not needed
+                    rounds[i][k].opponent = -1;
+                    break;
+                case bye: // not needed
+                    rounds[i][k].opponent = -1;
+                    break;
+            }
+        }
+    }
+
+    return R;
+}
+
+void gtmpi_free_schedule(round_t **rounds, int num_processes){
+    for(int i=0; i< num_processes; i++)
+        free(rounds[i]);
+    free(rounds);
+}
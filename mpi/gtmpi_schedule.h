@@ -0,0 +1,23 @@
+#ifndef GTMPI_SCHEDULE_H
+#define GTMPI_SCHEDULE_H
+
+#include "gtmpi.h"
+
+/*
+    Static tournament schedule (the MCS round_t roles), shared by the
+    tournament barrier (gtmpi2.c), the MPI phase of the combined barriers
+    (combined/tournament.c) and the scaling simulator (sim/), which
+    replays the exact roles the library builds. Needs no MPI.
+
+    Returns rounds[0..P-1][0..num_rounds] with rounds[i][0] = dropout and
+    *num_rounds = ceil(log2(P)). For P = 1 that is 0: there is no round 1,
+    and callers must not walk the schedule.
+
+    gtmpi_fill_schedule writes the same table into zeroed rows the caller
+    allocated (ceil(log2(P)) + 1 entries each) and returns the round count.
+*/
+round_t **gtmpi_tournament_schedule(int num_processes, int *num_rounds);
+int gtmpi_fill_schedule(round_t **rounds, int num_processes);
+void gtmpi_free_schedule(round_t **rounds, int num_processes);
+
+#endif
@@ -0,0 +1,238 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <mpi.h>
+#include "gtmpi.h"
+#include "gtmpi_algos.h"
+#include "gtstats.h"
+#include "gtsweep.h"
+#include "gtwork.h"
+
+/*
+    In-process sweep over process counts, algorithms, workloads and
+    episode counts (mpi_sweep), replacing the per-count relaunch loops of the sbatch files.
+    See gtsweep.h for the warm-up, repetition and output rules and
+    gtwork.h for the workload specs.
+
+    Launch it once with the largest process count (mpirun -np N, or srun
+    in an allocation); each point with P < N runs on a communicator of
+    ranks 0..P-1 (gtmpi_comm) while the other ranks wait. Rank 0 writes
+    the output.
+
+    Usage: mpirun -np N ./mpi_sweep [-p procs] [-a algo,...] [-w workload,...]
+                                    [-r reps] [-e episodes,...] [-f csv|json] [-o file]
+    -p and -e take lists like "2,4,8" or "2-12".
+    Defaults: 2..N processes, every algorithm in gtmpi_algos[], no work,
+    10 repetitions of 1000 episodes, CSV on stdout.
+*/
+MPI_Comm gtmpi_comm = MPI_COMM_WORLD;
+
+static int world_rank;
+
+// count episodes, numbered from *episode; on rank 0 returns the mean barrier time over ranks, *wall_ns the slowest rank's time per episode
+static double run_episodes(const gtmpi_algo_t *algo, int P, const gtwork_t *work, uint64_t *episode, int count,
+                           gtstats_hist_t *hist, double *wall_ns){
+    double barrier_ns = 0, total = 0, wall, slowest;
+    uint64_t first = *episode;
+    int me;
+
+    MPI_Comm_rank(gtmpi_comm, &me);
+
+    algo->barrier(); // line everybody up before the clock starts
+    uint64_t start = gtstats_now();
+    for (int i = 0; i < count; i++)
+    {
+        gtwork_run(work, me, P, first + i);
+        uint64_t arrive = gtstats_now();
+        algo->barrier();
+        uint64_t latency = gtstats_now() - arrive;
+        barrier_ns += latency;
+        if (hist != NULL)
+            gtstats_hist_record(hist, latency);
+    }
+    wall = (double)(gtstats_now() - start) / count;
+    *episode += count;
+
+    MPI_Reduce(&barrier_ns, &total, 1, MPI_DOUBLE, MPI_SUM, 0, gtmpi_comm);
+    MPI_Reduce(&wall, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, gtmpi_comm);
+    *wall_ns = slowest;
+    return total / ((double)P * count);
+}
+
+// merge every rank's histogram into rank 0's
+static void reduce_latency(gtstats_hist_t *local, gtstats_hist_t *global){
+    gtstats_hist_init(global);
+    MPI_Reduce(local->buckets, global->buckets, GTSTATS_BUCKETS, MPI_UINT64_T, MPI_SUM, 0, gtmpi_comm);
+    MPI_Reduce(&local->count, &global->count, 1, MPI_UINT64_T, MPI_SUM, 0, gtmpi_comm);
+    MPI_Reduce(&local->sum, &global->sum, 1, MPI_DOUBLE, MPI_SUM, 0, gtmpi_comm);
+    MPI_Reduce(&local->min, &global->min, 1, MPI_UINT64_T, MPI_MIN, 0, gtmpi_comm);
+    MPI_Reduce(&local->max, &global->max, 1, MPI_UINT64_T, MPI_MAX, 0, gtmpi_comm);
+}
+
+static void run_point(gtsweep_out_t *out, const gtmpi_algo_t *algo, int P, const gtwork_t *work, int reps, int episodes){
+    double *barrier = (double*)malloc(reps * sizeof(double));
+    double *wall = (double*)malloc(reps * sizeof(double));
+    gtstats_hist_t local, latency;
+    gtsweep_steady_t steady;
+    double mean, wall_ns;
+    uint64_t episode = 0;
+    int done = 0;
+
+    algo->init(P);
+
+    // rank 0 judges the warm-up, everyone follows its decision
+    gtsweep_steady_init(&steady);
+    while (!done)
+    {
+        mean = run_episodes(algo, P, work, &episode, episodes, NULL, &wall_ns);
+        if (world_rank == 0)
+        {
+            gtsweep_steady_add(&steady, mean);
+            done = gtsweep_steady_done(&steady);
+        }
+        MPI_Bcast(&done, 1, MPI_INT, 0, gtmpi_comm);
+    }
+
+    gtstats_hist_init(&local);
+    for (int r = 0; r < reps; r++)
+        barrier[r] = run_episodes(algo, P, work, &episode, episodes, &local, &wall[r]);
+
+    algo->finalize();
+    reduce_latency(&local, &latency);
+
+    if (world_rank == 0)
+    {
+        gtsweep_row_t row = {
+            .driver = "mpi",
+            .algorithm = algo->name,
+            .P = P,
+            .workload = work->spec,
+            .reps = reps,
+            .episodes = episodes,
+            .warmup_batches = steady.batches,
+            .steady = steady.stable >= GTSWEEP_STABLE_BATCHES,
+            .barrier_ns = gtsweep_summarize(barrier, reps),
+            .episode_ns = gtsweep_summarize(wall, reps),
+            .p50_ns = gtstats_hist_percentile(&latency, 50),
+            .p99_ns = gtstats_hist_percentile(&latency, 99),
+        };
+        gtsweep_write(out, &row);
+    }
+
+    free(barrier);
+    free(wall);
+}
+
+static void fail(const char *message){
+    if (world_rank == 0)
+        fprintf(stderr, "mpi_sweep: %s\n", message);
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv){
+    char default_procs[32];
+    char *procs = default_procs, *algos = NULL, *workloads = "0", *episodes = "1000", *format = "csv", *path = NULL;
+    int reps = 10, opt, world_size;
+    int proc_list[GTSWEEP_MAX_LIST], episode_list[GTSWEEP_MAX_LIST];
+    gtwork_t work_list[GTSWEEP_MAX_LIST];
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    snprintf(default_procs, sizeof(default_procs), "%d-%d", world_size > 1 ? 2 : 1, world_size);
+    while ((opt = getopt(argc, argv, "p:a:w:r:e:f:o:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'p': procs = optarg; break;
+            case 'a': algos = optarg; break;
+            case 'w': workloads = optarg; break;
+            case 'r': reps = strtol(optarg, NULL, 10); break;
+            case 'e': episodes = optarg; break;
+            case 'f': format = optarg; break;
+            case 'o': path = optarg; break;
+            default:
+                fail("usage: mpi_sweep [-p procs] [-a algo,...] [-w workload,...] [-r reps] [-e episodes,...] [-f csv|json] [-o file]");
+        }
+    }
+
+    int n_procs = gtsweep_parse_list(procs, proc_list, GTSWEEP_MAX_LIST);
+    int n_episodes = gtsweep_parse_list(episodes, episode_list, GTSWEEP_MAX_LIST);
+    if (n_procs == 0 || n_episodes == 0 || reps < 1)
+        fail("bad -p, -r or -e");
+    for (int e = 0; e < n_episodes; e++)
+    {
+        if (episode_list[e] < 1)
+            fail("episode counts start at 1");
+    }
+    for (int p = 0; p < n_procs; p++)
+    {
+        if (proc_list[p] < 1 || proc_list[p] > world_size)
+            fail("process counts must be between 1 and the number of ranks launched");
+    }
+
+    int n_work = 0;
+    char *specs = strdup(workloads), *save;
+    for (char *spec = strtok_r(specs, ",", &save); spec != NULL; spec = strtok_r(NULL, ",", &save))
+    {
+        if (n_work == GTSWEEP_MAX_LIST)
+            fail("too many workloads in -w");
+        if (!gtwork_parse(&work_list[n_work++], spec))
+            fail("bad workload in -w");
+    }
+    free(specs);
+
+    // resolve the algorithm names before starting, so a typo does not waste a sweep
+    const gtmpi_algo_t *selected[GTSWEEP_MAX_LIST];
+    int n_algos = 0;
+    if (algos == NULL)
+    {
+        for (int i = 0; i < gtmpi_num_algos; i++)
+            selected[n_algos++] = &gtmpi_algos[i];
+    }
+    else
+    {
+        char *copy = strdup(algos), *save;
+        for (char *name = strtok_r(copy, ",", &save); name != NULL; name = strtok_r(NULL, ",", &save))
+        {
+            if (n_algos == GTSWEEP_MAX_LIST)
+                fail("too many algorithms in -a");
+            if ((selected[n_algos++] = gtmpi_find_algo(name)) == NULL)
+                fail("unknown algorithm in -a");
+        }
+        free(copy);
+    }
+
+    gtsweep_out_t out;
+    int opened = world_rank != 0 || gtsweep_open(&out, path, format);
+    MPI_Bcast(&opened, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (!opened)
+        fail("cannot open the output file");
+
+    for (int p = 0; p < n_procs; p++)
+    {
+        int P = proc_list[p];
+        MPI_Comm sub;
+
+        MPI_Comm_split(MPI_COMM_WORLD, world_rank < P ? 0 : MPI_UNDEFINED, world_rank, &sub);
+        if (sub != MPI_COMM_NULL)
+        {
+            gtmpi_comm = sub;
+            for (int a = 0; a < n_algos; a++)
+                for (int w = 0; w < n_work; w++)
+                    for (int e = 0; e < n_episodes; e++)
+                        run_point(&out, selected[a], P, &work_list[w], reps, episode_list[e]);
+            gtmpi_comm = MPI_COMM_WORLD;
+            MPI_Comm_free(&sub);
+        }
+        MPI_Barrier(MPI_COMM_WORLD); // idle ranks wait here
+    }
+
+    if (world_rank == 0)
+        gtsweep_close(&out);
+    MPI_Finalize();
+    return 0;
+}
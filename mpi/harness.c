@@ -4,11 +4,35 @@
 #include <mpi.h>
 #include <time.h>
 #include "gtmpi.h"
+#include "gtstats.h"
+#include "gtperf.h"
+#include "gtwork.h"
+
+MPI_Comm gtmpi_comm = MPI_COMM_WORLD;
+
+// merge every rank's histogram into rank 0's
+static void reduce_latency(gtstats_hist_t *local, gtstats_hist_t *global){
+  gtstats_hist_init(global);
+  MPI_Reduce(local->buckets, global->buckets, GTSTATS_BUCKETS, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local->count, &global->count, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local->sum, &global->sum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local->min, &global->min, 1, MPI_UINT64_T, MPI_MIN, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local->max, &global->max, 1, MPI_UINT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
+}
+
+// combine every rank's FTQ pass on rank 0 (every rank runs the same number of quanta)
+static void reduce_ftq(gtwork_ftq_t *local, gtwork_ftq_t *global, int num_processes){
+  MPI_Reduce(&local->samples, &global->samples, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local->mean, &global->mean, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local->min, &global->min, 1, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&local->max, &global->max, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+  global->mean /= num_processes;
+}
 
 int main(int argc, char** argv)
 {
   double time_diff_sum;
-  struct timespec tstart, tend;
+  uint64_t tstart, tend;
   double dt;
 
   int num_processes, my_id;
@@ -33,9 +57,26 @@ int main(int argc, char** argv)
   MPI_Comm_size(MPI_COMM_WORLD, &num_processes); // just in case execution differs with argc
   MPI_Comm_rank(MPI_COMM_WORLD, &my_id);
 
+  // GT_WORK=<spec>: synthetic compute before every barrier (gtwork.h)
+  gtwork_t work;
+  int has_work = gtwork_from_env(&work);
+
+  // GT_FTQ=<quantum_ns>: OS noise on every rank before the experiments
+  uint64_t quantum = getenv("GT_FTQ") != NULL ? strtoull(getenv("GT_FTQ"), NULL, 10) : 0;
+  gtwork_ftq_t noise, global_noise;
+  if(quantum > 0){
+    gtwork_ftq(quantum, GTWORK_FTQ_SAMPLES, &noise);
+    reduce_ftq(&noise, &global_noise, num_processes);
+  }
+
+  // episode latencies, preallocated so the barrier loop never allocates
+  uint64_t *episodes = (uint64_t*)malloc(num_iter * sizeof(uint64_t));
+  gtstats_hist_t latency, global_latency;
+  gtstats_hist_init(&latency);
+
   for(int j=0; j< exp_iter; j++){
     gtmpi_init(num_processes);
-    clock_gettime(CLOCK_REALTIME, &tstart);
+    tstart = gtstats_now();
 
     /* ==============================================
     Parellel part
@@ -43,15 +84,22 @@ int main(int argc, char** argv)
     int i = 0;
     for(i=0; i < num_iter; i++){
       pub += my_id;  
+      if(has_work)
+        gtwork_run(&work, my_id, num_processes, (uint64_t)j * num_iter + i);
 
+      uint64_t arrive = gtstats_now();
       gtmpi_barrier();
+      episodes[i] = gtstats_now() - arrive;
     }
 
     /* ==============================================
     Timing check & clean up
     ==============================================*/
-    clock_gettime(CLOCK_REALTIME, &tend);
-    dt = (tend.tv_sec*1e6+tend.tv_nsec/1e3)-(tstart.tv_sec*1e6+tstart.tv_nsec/1e3);
+    tend = gtstats_now();
+    dt = (tend - tstart) / 1e3;
+
+    for(i=0; i < num_iter; i++)
+      gtstats_hist_record(&latency, episodes[i]);
 
     MPI_Reduce(&dt, &time_diff_sum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
 
@@ -61,9 +109,42 @@ int main(int argc, char** argv)
     gtmpi_finalize();  
   }
 
+  reduce_latency(&latency, &global_latency);
+  free(episodes);
+
+  // GT_PERF=1: one extra, untimed pass with per-rank hardware counters
+  int profile = getenv("GT_PERF") != NULL;
+  int perf_iter = num_iter * 100;
+  gtperf_counts_t counts, global_counts;
+  if(profile){
+    gtperf_t perf;
+    gtperf_counts_init(&counts);
+    gtperf_counts_init(&global_counts);
+
+    gtmpi_init(num_processes);
+    gtperf_open(&perf);
+    gtmpi_barrier(); // every rank has its counters before any starts
+    gtperf_start(&perf);
+    for(int k = 0; k < perf_iter; k++)
+      gtmpi_barrier();
+    gtperf_stop(&perf, &counts);
+    gtperf_close(&perf);
+    gtmpi_finalize();
+
+    MPI_Reduce(counts.value, global_counts.value, GTPERF_EVENTS, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(counts.valid, global_counts.valid, GTPERF_EVENTS, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+  }
+
   if(my_id == 0){
     fprintf(stdout, "Average time taken for %d experiments: %ld μs\n", exp_iter, (total_time/num_processes)/exp_iter);
     fprintf(stderr, "%d, %ld\n", num_processes, (total_time/num_processes)/exp_iter);
+    if(quantum > 0)
+      gtwork_ftq_report(stdout, "OS noise", quantum, &global_noise);
+    if(has_work)
+      printf("Workload: %s\n", work.spec);
+    gtstats_hist_report(stdout, "Barrier episode latency", &global_latency, getenv("GT_HIST") != NULL);
+    if(profile)
+      gtperf_report(stdout, "Barrier counters", &global_counts, perf_iter);
   }
 
   MPI_Finalize();
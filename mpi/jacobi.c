@@ -0,0 +1,134 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <mpi.h>
+#include "gtmpi.h"
+#include "gtjacobi.h"
+#include "gtstats.h"
+
+/*
+    Bulk-synchronous Jacobi mini-app (mpi_jacobi). The grid's planes are
+    split into one slab per rank. Every iteration:
+        halo        MPI_Sendrecv of the edge planes with both neighbours
+        compute     relax the slab
+        barrier     gtmpi_barrier closes the superstep
+        residual    MPI_Allreduce of the partial residuals, every -c
+                    iterations (default every one) and on the last
+    Rank 0 reports time to solution and the share of each phase,
+    averaged over ranks; synchronization is barrier plus residual.
+
+    It links against any gtmpi barrier, like the harness; by default the
+    runtime-dispatched one (GTMPI_BARRIER=<name>, see gtmpi_auto.c).
+
+    Usage: mpirun -np N ./mpi_jacobi [-g grid] [-i iterations] [-e tolerance] [-c check]
+    Defaults: 1024x1024, 1000 iterations, tolerance 0 (run every
+    iteration), check 1.
+*/
+MPI_Comm gtmpi_comm = MPI_COMM_WORLD;
+
+enum phase{phase_halo, phase_barrier, phase_reduce, phases};
+
+int main(int argc, char **argv){
+    gtjacobi_grid_t grid;
+    char *spec = "1024x1024";
+    int iterations = 1000, check = 1, opt, num_processes, my_id;
+    double tolerance = 0;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_processes);
+    MPI_Comm_rank(MPI_COMM_WORLD, &my_id);
+
+    while ((opt = getopt(argc, argv, "g:i:e:c:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'g': spec = optarg; break;
+            case 'i': iterations = strtol(optarg, NULL, 10); break;
+            case 'e': tolerance = strtod(optarg, NULL); break;
+            case 'c': check = strtol(optarg, NULL, 10); break;
+            default:
+                if (my_id == 0)
+                    fprintf(stderr, "Usage: %s [-g NXxNY[xNZ]] [-i iterations] [-e tolerance] [-c check]\n", argv[0]);
+                MPI_Finalize();
+                exit(EXIT_FAILURE);
+        }
+    }
+    if (!gtjacobi_parse(&grid, spec) || iterations < 1 || check < 1 || grid.planes < num_processes)
+    {
+        if (my_id == 0)
+            fprintf(stderr, "mpi_jacobi: bad -g, -i or -c (the grid needs a plane per rank)\n");
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    int first, last;
+    gtjacobi_split(grid.planes, num_processes, my_id, &first, &last);
+    int n = last - first + 1;
+    int up = my_id > 0 ? my_id - 1 : MPI_PROC_NULL;
+    int down = my_id < num_processes - 1 ? my_id + 1 : MPI_PROC_NULL;
+
+    double *old = gtjacobi_alloc(&grid, n, my_id == 0);
+    double *new = gtjacobi_alloc(&grid, n, my_id == 0);
+    if (old == NULL || new == NULL)
+    {
+        fprintf(stderr, "mpi_jacobi: rank %d out of memory\n", my_id);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    gtmpi_init(num_processes);
+
+    double spent[phases] = {0}, total[phases], sum, residual = 0, *swap;
+    uint64_t t, start = gtstats_now();
+    int k;
+    for (k = 0; k < iterations; k++)
+    {
+        t = gtstats_now();
+        MPI_Sendrecv(old + grid.plane, grid.plane, MPI_DOUBLE, up, 0,
+                     old + (n + 1) * grid.plane, grid.plane, MPI_DOUBLE, down, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        MPI_Sendrecv(old + n * grid.plane, grid.plane, MPI_DOUBLE, down, 1,
+                     old, grid.plane, MPI_DOUBLE, up, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        spent[phase_halo] += gtstats_now() - t;
+
+        sum = gtjacobi_sweep(&grid, old, new, 1, n);
+
+        t = gtstats_now();
+        gtmpi_barrier();
+        spent[phase_barrier] += gtstats_now() - t;
+
+        swap = old;
+        old = new;
+        new = swap;
+
+        if ((k + 1) % check == 0 || k == iterations - 1)
+        {
+            t = gtstats_now();
+            MPI_Allreduce(&sum, &residual, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+            spent[phase_reduce] += gtstats_now() - t;
+            residual = sqrt(residual);
+            if (residual < tolerance)
+            {
+                k++;
+                break;
+            }
+        }
+    }
+    uint64_t wall = gtstats_now() - start;
+    gtmpi_finalize();
+
+    MPI_Reduce(spent, total, phases, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (my_id == 0)
+    {
+        for (int p = 0; p < phases; p++)
+            total[p] /= num_processes;
+        printf("%d processes\n", num_processes);
+        gtjacobi_report(stdout, &grid, k, residual, wall, total[phase_barrier] + total[phase_reduce]);
+        printf("Phases: halo %.1f%% | barrier %.1f%% | residual %.1f%%\n",
+            100 * total[phase_halo] / wall, 100 * total[phase_barrier] / wall, 100 * total[phase_reduce] / wall);
+    }
+
+    free(old);
+    free(new);
+    MPI_Finalize();
+    return 0;
+}
@@ -3,9 +3,40 @@
 #ifndef GTMP_H
 #define GTMP_H
 
+/*
+    Every implementation defines gtmp_init/gtmp_barrier/gtmp_finalize, and
+    the Makefile links exactly one of them per binary. The autotuned build
+    (mp_auto) links all of them instead. Each one is compiled with
+    -DGTMP_ALGO=<name>, so its entry points become <name>_init,
+    <name>_barrier and <name>_finalize (see gtmp_algos.h).
+*/
+#ifdef GTMP_ALGO
+#define GTMP_PASTE(algo, fn) algo##fn
+#define GTMP_NAME(algo, fn) GTMP_PASTE(algo, fn)
+#define gtmp_init GTMP_NAME(GTMP_ALGO, _init)
+#define gtmp_barrier GTMP_NAME(GTMP_ALGO, _barrier)
+#define gtmp_finalize GTMP_NAME(GTMP_ALGO, _finalize)
+#endif
+
+/*
+    Thread identity. By default the barriers run on an OpenMP team and a
+    thread's id is omp_get_thread_num(). Built with -DGTMP_PTHREADS they
+    run on plain pthreads (pt_harness.c, or any thread pool): every thread
+    calls gtmp_thread_register with its id in 0..P-1 before its first
+    barrier. Per-thread barrier state is __thread in both builds.
+*/
+#ifdef GTMP_PTHREADS
+extern __thread int gtmp_thread_id;
+#define gtmp_thread_num() gtmp_thread_id
+void gtmp_thread_register(int thread_id);
+#else
+#include <omp.h>
+#define gtmp_thread_num() omp_get_thread_num()
+#endif
+
 extern int P;
 extern int count;
-extern bool sense;
+extern int sense;
 
 void gtmp_init(int num_threads);
 void gtmp_barrier();				
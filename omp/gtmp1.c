@@ -1,8 +1,9 @@
-#include <omp.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
+#include "gtarena.h"
 #include "gtmp.h"
+#include "gtmp_trace.h"
+#include "gtspin.h"
 
 /*
 Dissemination Barrier
@@ -34,56 +35,185 @@ procedure dissemination_barrier
     parity := 1 - parity
 */
 
-int **flags;
-int n_threads;
-int rounds;
-static int parity = 0;
-static int local_sense = 1;
-
-#pragma omp threadprivate(parity, local_sense)
+/*
+    Build-time knob (make RADIX=4 sets it):
+        GTMP1_RADIX   n-way dissemination: every round signals RADIX-1
+                      partners at distances j * RADIX^round, so a team
+                      needs ceil(log_RADIX(P)) rounds (default 2)
+    Waiting on a flag goes through gtspin_until (GT_SPIN, see gtspin.h).
+
+    gtmp_init precomputes, per thread and parity, the flag each step signals
+    and the flag it waits on, so the spin path does no modulo or index
+    arithmetic. Teams of 8, 16, 32 and 64 threads additionally get kernels
+    compiled with the step count as a constant (fully unrolled); any other
+    P runs the same kernel with a runtime step count. All of them are
+    compiled at -O3 whatever CFLAGS say, so fixed and generic teams differ
+    only in the specialization.
+
+    Flags and schedule come from one arena (GT_ARENA, see gtarena.h): each
+    thread's region holds the flags it spins on and its own schedule, so
+    re-initializing between experiments allocates nothing, and with
+    GT_ARENA=numa a thread moves its region to its node on its first
+    episode on a new mapping.
+*/
+#ifndef GTMP1_RADIX
+#define GTMP1_RADIX 2
+#endif
+
+// ceil(log_RADIX(P)) as a constant expression, for the fixed team sizes
+#define GTMP1_R GTMP1_RADIX
+#define GTMP1_ROUNDS(P) ((P) <= 1 ? 0 : (P) <= GTMP1_R ? 1 : (P) <= GTMP1_R * GTMP1_R ? 2 \
+    : (P) <= GTMP1_R * GTMP1_R * GTMP1_R ? 3 : (P) <= GTMP1_R * GTMP1_R * GTMP1_R * GTMP1_R ? 4 \
+    : (P) <= GTMP1_R * GTMP1_R * GTMP1_R * GTMP1_R * GTMP1_R ? 5 : 6)
+
+static gtarena_t arena;          // region per thread: flag row [parity][step], then its schedule
+static volatile int ***schedule; // schedule[thread][parity * 2 * steps + {0: send, steps: wait} + step]
+static int rounds;
+static int steps;                // rounds * (RADIX - 1)
+static int fixed_team;           // P if a specialized kernel exists, else 0
+static int generation;           // bumped by gtmp_init
+static __thread int parity = 0;
+static __thread int local_sense = 1;
+static __thread int joined = 0;  // generation this thread's parity and sense belong to
 
 void gtmp_init(int num_threads){
-    n_threads = num_threads;
-    rounds = (int)ceil(log2(num_threads)); // calculate rounds
+    generation++;
+    rounds = 0; // calculate rounds: smallest k with RADIX^k >= P
+    for (int reach = 1; reach < num_threads; reach *= GTMP1_RADIX)
+    {
+        rounds++;
+    }
+    steps = rounds * (GTMP1_RADIX - 1);
+
+    switch (num_threads)
+    {
+        case 8: case 16: case 32: case 64:
+            fixed_team = num_threads;
+            break;
+        default:
+            fixed_team = 0;
+            break;
+    }
 
-    // allocate memory for flags: flags[thread_id][parity][round]
-    flags = (int**)malloc(num_threads * sizeof(int*));
+    // region layout: flag row padded to a cache line, then 4 * steps + 1 schedule pointers
+    size_t row = GTARENA_SIZE(2 * steps * sizeof(int));
+    if (row == 0)
+        row = GTARENA_LINE;
+    gtarena_begin(&arena, num_threads, row + (4 * steps + 1) * sizeof(volatile int*),
+                  GTARENA_SIZE(num_threads * sizeof(volatile int**)));
+    schedule = (volatile int***)gtarena_alloc(&arena, num_threads * sizeof(volatile int**));
+
+    // if j = (i + k * RADIX^r) mod P, step (r, k) of i signals j's flag for (r, k)
     for (int i = 0; i < num_threads; i++)
     {
-        flags[i] = (int*)malloc(2 * rounds * sizeof(int));
-        for (int j = 0; j < 2 * rounds; j++)
+        schedule[i] = (volatile int**)((char*)gtarena_region(&arena, i) + row);
+        for (int p = 0; p < 2; p++)
         {
-            flags[i][j] = 0; // init all flags to 0
+            int distance = 1;
+            for (int r = 0; r < rounds; r++)
+            {
+                for (int k = 1; k < GTMP1_RADIX; k++)
+                {
+                    int step = r * (GTMP1_RADIX - 1) + k - 1;
+                    int peer = (i + k * distance) % num_threads;
+                    schedule[i][p * 2 * steps + step] = (int*)gtarena_region(&arena, peer) + p * steps + step;
+                    schedule[i][p * 2 * steps + steps + step] = (int*)gtarena_region(&arena, i) + p * steps + step;
+                }
+                distance *= GTMP1_RADIX;
+            }
         }
     }
+    gtspin_init();
+    gtmp_trace_init(num_threads, rounds);
 }
 
-void gtmp_barrier(){
-    int thread_id = omp_get_thread_num();
+#pragma GCC push_options
+#pragma GCC optimize ("O3")
 
-    for (int round = 0; round < rounds; round++)
+static inline __attribute__((always_inline)) void dissemination_kernel(int thread_id, const int team_rounds){
+    const int team_steps = team_rounds * (GTMP1_RADIX - 1);
+    volatile int **send = schedule[thread_id] + parity * 2 * team_steps;
+    volatile int **wait = send + team_steps;
+    const int my_sense = local_sense;
+
+    #pragma GCC unroll 8
+    for (int round = 0; round < team_rounds; round++)
     {
-        int peer = (thread_id + (1 << round)) % n_threads;
-        flags[peer][parity * rounds + round] = local_sense;
+        for (int k = 0; k < GTMP1_RADIX - 1; k++)
+        {
+            *send[round * (GTMP1_RADIX - 1) + k] = my_sense;
+        }
 
-        // spin on local sense until peer sends wake up call
-        while (flags[thread_id][parity * rounds + round] != local_sense);
+        // spin on local sense until every peer of this round sends its wake up call
+        for (int k = 0; k < GTMP1_RADIX - 1; k++)
+        {
+            gtspin_until(wait[round * (GTMP1_RADIX - 1) + k], my_sense, NULL, 1);
+        }
+        gtmp_trace_round(thread_id, round);
     }
 
     if (parity == 1)
     {
-        local_sense = !local_sense;
+        local_sense = !my_sense;
     }
-    
+
     parity = 1 - parity; // alternate parity
 }
 
-void gtmp_finalize(){
-    for (int i = 0; i < n_threads; i++)
+#define FIXED_KERNEL(P) \
+    static __attribute__((noinline)) void dissemination_##P(int thread_id){ \
+        dissemination_kernel(thread_id, GTMP1_ROUNDS(P)); \
+    }
+
+FIXED_KERNEL(8)
+FIXED_KERNEL(16)
+FIXED_KERNEL(32)
+FIXED_KERNEL(64)
+
+static __attribute__((noinline)) void dissemination_generic(int thread_id){
+    dissemination_kernel(thread_id, rounds);
+}
+
+#pragma GCC pop_options
+
+void gtmp_barrier(){
+    int thread_id = gtmp_thread_num();
+    gtmp_trace_arrive(thread_id);
+
+    // first episode on freshly zeroed flags: the thread's parity and sense
+    // outlive gtmp_finalize, so they restart here; the region moves to this
+    // thread's node with its contents, so early peer signals survive
+    if (joined != generation)
     {
-        free(flags[i]);
+        joined = generation;
+        parity = 0;
+        local_sense = 1;
+        gtarena_place_here(&arena, thread_id);
     }
 
-    free(flags);
+    switch (fixed_team)
+    {
+        case 8:
+            dissemination_8(thread_id);
+            break;
+        case 16:
+            dissemination_16(thread_id);
+            break;
+        case 32:
+            dissemination_32(thread_id);
+            break;
+        case 64:
+            dissemination_64(thread_id);
+            break;
+        default:
+            dissemination_generic(thread_id);
+            break;
+    }
+
+    gtmp_trace_release(thread_id);
 }
 
+void gtmp_finalize(){
+    gtmp_trace_finalize();
+    // the arena stays mapped for the next gtmp_init
+}
@@ -1,5 +1,6 @@
-#include <omp.h>
 #include "gtmp.h"
+#include "gtmp_trace.h"
+#include "gtspin.h"
 #include <stdio.h> 
 
 /*
@@ -19,30 +20,40 @@
 */
 int P;
 int count;
-bool sense;
-static bool local_sense = true;
-#pragma omp threadprivate(local_sense)
+int sense;
 
 void gtmp_init(int num_threads){
     P = num_threads;
     count = P;
-    sense = true;
+    sense = 1;
+    gtspin_init();
+    gtmp_trace_init(num_threads, 1); // one step: the counter decrement
 }
 
 void gtmp_barrier(){ 
-
-    local_sense = !local_sense; // each processor toggles its own sense
-    #pragma omp critical // if fetch_and_decrement ($count) = 1
-        {
-            count--;
-            if(count == 0){
-                count = P;
-                sense = local_sense; // last processor toggles global sense
-            }
-        }
-
-    while(sense != local_sense);
+#ifdef GTMP_TRACE
+    int thread_id = gtmp_thread_num();
+#endif
+    gtmp_trace_arrive(thread_id);
+
+    // each processor toggles its own sense: sense cannot flip before this
+    // thread has decremented count, so its value on entry is the previous
+    // local sense, and no per-thread state has to survive gtmp_init
+    int local_sense = !__atomic_load_n(&sense, __ATOMIC_ACQUIRE);
+    int left = __atomic_sub_fetch(&count, 1, __ATOMIC_ACQ_REL);
+    if (left == 0) // if fetch_and_decrement (&count) = 1
+    {
+        __atomic_store_n(&count, P, __ATOMIC_RELAXED);
+        __atomic_store_n(&sense, local_sense, __ATOMIC_RELEASE); // last processor toggles global sense
+    }
+    gtmp_trace_round(thread_id, 0);
+
+    // waiters back off in proportion to the threads still to arrive,
+    // never more than when this one arrived
+    gtspin_until((volatile int*)&sense, local_sense, (volatile int*)&count, left);
+    gtmp_trace_release(thread_id);
 }
 
 void gtmp_finalize(){
+    gtmp_trace_finalize();
 }
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "gtarena.h"
+#include "gtmp.h"
+#include "gtmp_steal.h"
+#include "gtmp_trace.h"
+#include "gtspin.h"
+
+/*
+    Work-stealing barrier
+
+    Each thread owns a Chase-Lev deque: the owner pushes and pops at the
+    bottom, thieves take from the top with a CAS. In gtmp_barrier a thread
+        1. runs its own queued tasks
+        2. decrements arrived
+        3. until the episode's generation changes: runs tasks from its own
+           deque (spawned by tasks it ran), else steals one from another
+           thread, else checks for completion
+    The episode is complete when arrived = 0 and pending = 0. pending
+    counts spawned tasks that have not finished, and a task's children are
+    counted before the task itself finishes, so once both are zero nothing
+    can be spawned any more. The waiter that wins the closing CAS resets
+    arrived and publishes generation + 1, which releases everyone.
+
+    With no tasks this is a centralized counter barrier whose waiters poll
+    the other deques between reads of the generation word.
+
+    The deques are the regions of an arena (GT_ARENA, see gtarena.h), kept
+    across re-initialization.
+*/
+typedef struct{
+    gtmp_task_fn fn;
+    void *arg;
+} task_t;
+
+typedef struct{
+    long top __attribute__((aligned(64)));    // thieves
+    long bottom __attribute__((aligned(64))); // owner
+    task_t tasks[GTMP_STEAL_CAPACITY];
+} deque_t;
+
+static gtarena_t arena;
+static int n_threads;
+static int arrived __attribute__((aligned(64)));
+static long pending __attribute__((aligned(64)));
+static int closing __attribute__((aligned(64)));
+static int generation __attribute__((aligned(64)));
+
+static inline deque_t *deque(int thread_id){
+    return (deque_t*)gtarena_region(&arena, thread_id);
+}
+
+void gtmp_init(int num_threads){
+    n_threads = num_threads;
+    gtarena_begin(&arena, num_threads, sizeof(deque_t), 0); // zeroed: every deque empty
+    arrived = num_threads;
+    pending = 0;
+    closing = 0;
+    generation = 0;
+    gtspin_init();
+    gtmp_trace_init(num_threads, 1); // one step: the arrival decrement
+}
+
+static void run(task_t task){
+    task.fn(task.arg);
+    __atomic_fetch_sub(&pending, 1, __ATOMIC_RELEASE);
+}
+
+static int pop(deque_t *dq, task_t *task){
+    long b = __atomic_load_n(&dq->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&dq->bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    long t = __atomic_load_n(&dq->top, __ATOMIC_RELAXED);
+
+    if (t > b) // empty
+    {
+        __atomic_store_n(&dq->bottom, b + 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    *task = dq->tasks[b & (GTMP_STEAL_CAPACITY - 1)];
+    if (t == b) // last task: race the thieves for it
+    {
+        int won = __atomic_compare_exchange_n(&dq->top, &t, t + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+        __atomic_store_n(&dq->bottom, b + 1, __ATOMIC_RELAXED);
+        return won;
+    }
+    return 1;
+}
+
+static int steal(deque_t *dq, task_t *task){
+    long t = __atomic_load_n(&dq->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    long b = __atomic_load_n(&dq->bottom, __ATOMIC_ACQUIRE);
+
+    if (t >= b)
+        return 0;
+    task_t *slot = &dq->tasks[t & (GTMP_STEAL_CAPACITY - 1)];
+    task->fn = __atomic_load_n(&slot->fn, __ATOMIC_RELAXED);
+    task->arg = __atomic_load_n(&slot->arg, __ATOMIC_RELAXED);
+    return __atomic_compare_exchange_n(&dq->top, &t, t + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+void gtmp_spawn(gtmp_task_fn fn, void *arg){
+    deque_t *dq = deque(gtmp_thread_num());
+    long b = __atomic_load_n(&dq->bottom, __ATOMIC_RELAXED);
+    long t = __atomic_load_n(&dq->top, __ATOMIC_ACQUIRE);
+
+    __atomic_fetch_add(&pending, 1, __ATOMIC_ACQ_REL); // before the parent task finishes
+    if (b - t >= GTMP_STEAL_CAPACITY)
+    {
+        run((task_t){ fn, arg });
+        return;
+    }
+    dq->tasks[b & (GTMP_STEAL_CAPACITY - 1)] = (task_t){ fn, arg };
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&dq->bottom, b + 1, __ATOMIC_RELAXED);
+}
+
+// one task from our own deque, else from the next thread that has one
+static int find_task(int thread_id, task_t *task){
+    if (pop(deque(thread_id), task))
+        return 1;
+    for (int i = 1; i < n_threads; i++)
+    {
+        if (steal(deque((thread_id + i) % n_threads), task))
+            return 1;
+    }
+    return 0;
+}
+
+void gtmp_barrier(){
+    int thread_id = gtmp_thread_num();
+    task_t task;
+    gtmp_trace_arrive(thread_id);
+    gtarena_place_here(&arena, thread_id); // GT_ARENA=numa: once per mapping
+
+    while (pop(deque(thread_id), &task))
+        run(task);
+
+    int episode = __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+    __atomic_fetch_sub(&arrived, 1, __ATOMIC_ACQ_REL);
+    gtmp_trace_round(thread_id, 0);
+
+    while (__atomic_load_n(&generation, __ATOMIC_ACQUIRE) == episode)
+    {
+        if (find_task(thread_id, &task))
+        {
+            run(task);
+            continue;
+        }
+        if (__atomic_load_n(&arrived, __ATOMIC_ACQUIRE) == 0 && __atomic_load_n(&pending, __ATOMIC_ACQUIRE) == 0
+            && __atomic_exchange_n(&closing, 1, __ATOMIC_ACQ_REL) == 0)
+        {
+            if (__atomic_load_n(&generation, __ATOMIC_RELAXED) == episode)
+            {
+                __atomic_store_n(&arrived, n_threads, __ATOMIC_RELAXED);
+                __atomic_store_n(&generation, episode + 1, __ATOMIC_RELEASE);
+            }
+            __atomic_store_n(&closing, 0, __ATOMIC_RELEASE);
+            break;
+        }
+        gtspin_poll();
+    }
+    gtmp_trace_release(thread_id);
+}
+
+void gtmp_finalize(){
+    gtmp_trace_finalize();
+}
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "gtmp.h"
+#include "gtmp_phaser.h"
+#include "gtmp_trace.h"
+#include "gtspin.h"
+
+/*
+    Phaser barrier
+
+    The whole barrier is one 64-bit word, updated with CAS:
+        bits 63..32  phase
+        bits 31..16  parties    (registered for the current phase)
+        bits 15..0   unarrived  (parties yet to arrive on it)
+    Register adds one to parties and unarrived, deregister takes one off
+    both. An arrival takes one off unarrived, and the arrival that would
+    make it zero instead starts the next phase with unarrived = parties.
+    The count is therefore "rebuilt" by the same CAS that completes a
+    phase, and membership changes cost one CAS instead of a re-init.
+    Waiters spin (gtspin_poll) on the phase bits.
+*/
+#define PHASE_SHIFT 32
+#define PARTIES_SHIFT 16
+#define UNARRIVED_MASK 0xffffull
+
+#define PHASE_OF(s) ((unsigned int)((s) >> PHASE_SHIFT))
+#define PARTIES_OF(s) ((int)(((s) >> PARTIES_SHIFT) & UNARRIVED_MASK))
+#define UNARRIVED_OF(s) ((int)((s) & UNARRIVED_MASK))
+#define STATE(phase, parties, unarrived) \
+    (((uint64_t)(phase) << PHASE_SHIFT) | ((uint64_t)(parties) << PARTIES_SHIFT) | (uint64_t)(unarrived))
+
+static uint64_t state __attribute__((aligned(64)));
+
+void gtmp_init(int num_threads){
+    if (num_threads > GTMP_PHASER_MAX_PARTIES)
+    {
+        fprintf(stderr, "gtmp_init: the phaser holds at most %d parties\n", GTMP_PHASER_MAX_PARTIES);
+        exit(EXIT_FAILURE);
+    }
+    state = STATE(0, num_threads, num_threads);
+    gtspin_init();
+    gtmp_trace_init(num_threads, 1); // one step: the arrival CAS; parties registered later are not traced
+}
+
+/*
+    Arrive on the current phase; leaving drops the party for the phases
+    after it. Returns the phase arrived on.
+*/
+static unsigned int arrive(int leaving){
+    uint64_t s = __atomic_load_n(&state, __ATOMIC_RELAXED), next;
+
+    do
+    {
+        unsigned int phase = PHASE_OF(s);
+        int parties = PARTIES_OF(s) - leaving;
+        int unarrived = UNARRIVED_OF(s);
+
+        if (unarrived == 0)
+        {
+            fprintf(stderr, "gtmp_phaser: arrival from an unregistered thread\n");
+            exit(EXIT_FAILURE);
+        }
+        if (unarrived == 1) // last arrival: open the next phase
+            next = STATE(phase + 1, parties, parties);
+        else
+            next = STATE(phase, parties, unarrived - 1);
+    } while (!__atomic_compare_exchange_n(&state, &s, next, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    return PHASE_OF(s);
+}
+
+unsigned int gtmp_phaser_register(void){
+    uint64_t s = __atomic_load_n(&state, __ATOMIC_RELAXED), next;
+
+    do
+    {
+        if (PARTIES_OF(s) == GTMP_PHASER_MAX_PARTIES)
+        {
+            fprintf(stderr, "gtmp_phaser: more than %d parties\n", GTMP_PHASER_MAX_PARTIES);
+            exit(EXIT_FAILURE);
+        }
+        next = STATE(PHASE_OF(s), PARTIES_OF(s) + 1, UNARRIVED_OF(s) + 1);
+    } while (!__atomic_compare_exchange_n(&state, &s, next, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    return PHASE_OF(s);
+}
+
+unsigned int gtmp_phaser_deregister(void){
+    return arrive(1);
+}
+
+unsigned int gtmp_phaser_arrive(void){
+    return arrive(0);
+}
+
+void gtmp_phaser_await(unsigned int phase){
+    // signed distance, so the comparison survives the phase wrapping around
+    while ((int)(PHASE_OF(__atomic_load_n(&state, __ATOMIC_ACQUIRE)) - phase) < 0)
+        gtspin_poll();
+}
+
+unsigned int gtmp_phaser_phase(void){
+    return PHASE_OF(__atomic_load_n(&state, __ATOMIC_ACQUIRE));
+}
+
+int gtmp_phaser_parties(void){
+    return PARTIES_OF(__atomic_load_n(&state, __ATOMIC_ACQUIRE));
+}
+
+void gtmp_barrier(){
+#ifdef GTMP_TRACE
+    int thread_id = gtmp_thread_num();
+#endif
+    gtmp_trace_arrive(thread_id);
+
+    unsigned int phase = arrive(0);
+    gtmp_trace_round(thread_id, 0);
+
+    gtmp_phaser_await(phase + 1);
+    gtmp_trace_release(thread_id);
+}
+
+void gtmp_finalize(){
+    gtmp_trace_finalize();
+}
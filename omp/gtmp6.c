@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "gtmp.h"
+#include "gtmp_epoch.h"
+#include "gtmp_trace.h"
+#include "gtspin.h"
+
+/*
+    Epoch barrier
+
+    shared tickets : 64-bit integer := 0
+    shared generation : 64-bit integer := 0
+
+    procedure arrive
+        ticket := fetch_and_increment(&tickets)
+        epoch := ticket / P + 1
+        if (ticket + 1) mod P = 0     // last arrival of the episode
+            generation := epoch       // the release is this one store
+        return epoch
+
+    procedure wait(epoch)
+        repeat until generation >= epoch
+
+    Tickets are never reset: episode N owns tickets [N*P, (N+1)*P). So
+    there is no count to restore before the release and no parity to keep
+    apart consecutive episodes. Sleepers block on the futex word holding
+    the low 32 bits of the generation, and the releaser only calls
+    FUTEX_WAKE when a sleeper has announced itself.
+*/
+static uint64_t tickets __attribute__((aligned(64)));
+static union{
+    uint64_t value;
+    uint32_t half[2]; // futexes are 32-bit: sleep on the low half
+} generation __attribute__((aligned(64)));
+static int sleepers __attribute__((aligned(64)));
+static uint64_t n_threads;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define GENERATION_LOW 0
+#else
+#define GENERATION_LOW 1
+#endif
+
+void gtmp_init(int num_threads){
+    n_threads = num_threads;
+    tickets = 0;
+    generation.value = 0;
+    sleepers = 0;
+    gtspin_init();
+    gtmp_trace_init(num_threads, 1); // one step: taking the ticket
+}
+
+static uint64_t load_generation(void){
+    return __atomic_load_n(&generation.value, __ATOMIC_ACQUIRE);
+}
+
+uint64_t gtmp_epoch_arrive(void){
+    uint64_t ticket = __atomic_fetch_add(&tickets, 1, __ATOMIC_ACQ_REL);
+    uint64_t epoch = ticket / n_threads + 1;
+
+    if (ticket + 1 == epoch * n_threads)
+    {
+        __atomic_store_n(&generation.value, epoch, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&sleepers, __ATOMIC_SEQ_CST) > 0)
+            syscall(SYS_futex, &generation.half[GENERATION_LOW], FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    }
+    return epoch;
+}
+
+/*
+    Sleep until the generation moves past seen or the timeout expires.
+    Announcing the sleeper before re-reading the generation pairs with the
+    releaser's store-then-check, so a wake-up is never lost.
+*/
+static void sleep_once(uint64_t seen, const struct timespec *timeout){
+    __atomic_fetch_add(&sleepers, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&generation.value, __ATOMIC_SEQ_CST) == seen)
+        syscall(SYS_futex, &generation.half[GENERATION_LOW], FUTEX_WAIT_PRIVATE, (uint32_t)seen, timeout, NULL, 0);
+    __atomic_fetch_sub(&sleepers, 1, __ATOMIC_RELAXED);
+}
+
+static uint64_t monotonic_ns(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+int gtmp_epoch_timed_wait(uint64_t epoch, uint64_t timeout_ns){
+    uint64_t deadline = monotonic_ns() + timeout_ns;
+    uint64_t seen;
+
+    for (int i = 0; i < GTMP_EPOCH_SPINS; i++)
+    {
+        if (load_generation() >= epoch)
+            return 1;
+        gtspin_poll();
+    }
+    while ((seen = load_generation()) < epoch)
+    {
+        uint64_t now = monotonic_ns();
+        if (now >= deadline)
+            return 0;
+        struct timespec left = { (deadline - now) / 1000000000ull, (deadline - now) % 1000000000ull };
+        sleep_once(seen, &left);
+    }
+    return 1;
+}
+
+void gtmp_epoch_wait(uint64_t epoch){
+    uint64_t seen;
+
+    for (int i = 0; i < GTMP_EPOCH_SPINS; i++)
+    {
+        if (load_generation() >= epoch)
+            return;
+        gtspin_poll();
+    }
+    while ((seen = load_generation()) < epoch)
+        sleep_once(seen, NULL);
+}
+
+uint64_t gtmp_epoch_current(void){
+    return load_generation();
+}
+
+void gtmp_barrier(){
+#ifdef GTMP_TRACE
+    int thread_id = gtmp_thread_num();
+#endif
+    gtmp_trace_arrive(thread_id);
+
+    uint64_t epoch = gtmp_epoch_arrive();
+    gtmp_trace_round(thread_id, 0);
+
+    gtmp_epoch_wait(epoch);
+    gtmp_trace_release(thread_id);
+}
+
+void gtmp_finalize(){
+    gtmp_trace_finalize();
+}
@@ -0,0 +1,34 @@
+#include <string.h>
+#include "gtmp_algos.h"
+
+#define DECLARE_ALGO(name) \
+    void name##_init(int num_threads); \
+    void name##_barrier(); \
+    void name##_finalize();
+
+DECLARE_ALGO(dissemination) // gtmp1.c
+DECLARE_ALGO(sense)         // gtmp2.c
+DECLARE_ALGO(phaser)        // gtmp5.c
+DECLARE_ALGO(epoch)         // gtmp6.c
+DECLARE_ALGO(omp)           // gtmp_control.c
+
+#define ALGO(name) { #name, name##_init, name##_barrier, name##_finalize }
+
+const gtmp_algo_t gtmp_algos[] = {
+    ALGO(dissemination),
+    ALGO(sense),
+    ALGO(phaser),
+    ALGO(epoch),
+    ALGO(omp),
+};
+
+const int gtmp_num_algos = sizeof(gtmp_algos) / sizeof(gtmp_algos[0]);
+
+const gtmp_algo_t *gtmp_find_algo(const char *name){
+    for (int i = 0; i < gtmp_num_algos; i++)
+    {
+        if (strcmp(gtmp_algos[i].name, name) == 0)
+            return &gtmp_algos[i];
+    }
+    return NULL;
+}
@@ -0,0 +1,20 @@
+#ifndef GTMP_ALGOS_H
+#define GTMP_ALGOS_H
+
+/*
+    Every OpenMP barrier linked into the all-algorithm build, under the
+    name its file was compiled with (-DGTMP_ALGO=<name>, see gtmp.h).
+*/
+typedef struct{
+    const char *name;
+    void (*init)(int num_threads);
+    void (*barrier)();
+    void (*finalize)();
+} gtmp_algo_t;
+
+extern const gtmp_algo_t gtmp_algos[];
+extern const int gtmp_num_algos;
+
+const gtmp_algo_t *gtmp_find_algo(const char *name);
+
+#endif
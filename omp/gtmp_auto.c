@@ -0,0 +1,107 @@
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "gtmp.h"
+#include "gtmp_algos.h"
+#include "gtstats.h"
+#include "gttune.h"
+
+/*
+    Autotuned barrier (mp_auto)
+
+    gtmp_init picks one of gtmp_algos[] for the team size and forwards
+    gtmp_barrier/gtmp_finalize to it. The choice, in order:
+        1. GTMP_BARRIER=<name> forces an algorithm
+        2. a cached decision for (host, P, topology), see gttune.h
+        3. a short calibration: each algorithm runs CALIBRATION_EPISODES
+           episodes on a team of P threads after a warm-up, and the lowest
+           mean wins and is added to the cache
+    The decision is kept for the process, so the harness re-initializing
+    the barrier for every experiment does not re-tune.
+
+    gtmp_init must be called outside of a parallel region, because
+    calibration starts its own team.
+*/
+#define WARMUP_EPISODES 100
+#define CALIBRATION_EPISODES 2000
+
+static const gtmp_algo_t *current;
+static int tuned_P = -1;
+
+static double calibrate(const gtmp_algo_t *algo, int num_threads){
+    uint64_t start = 0, end = 0;
+
+    algo->init(num_threads);
+    #pragma omp parallel num_threads(num_threads)
+    {
+        for (int i = 0; i < WARMUP_EPISODES; i++)
+        {
+            algo->barrier();
+        }
+        #pragma omp master
+        start = gtstats_now();
+        for (int i = 0; i < CALIBRATION_EPISODES; i++)
+        {
+            algo->barrier();
+        }
+        #pragma omp master
+        end = gtstats_now();
+    }
+    algo->finalize();
+
+    return (double)(end - start) / CALIBRATION_EPISODES;
+}
+
+static const gtmp_algo_t *choose(int num_threads){
+    char *forced = getenv("GTMP_BARRIER");
+    char host[64], topology[64], key[GTTUNE_KEY_MAX], cached[GTTUNE_NAME_MAX];
+    const gtmp_algo_t *best = NULL;
+    double best_ns = 0;
+
+    if (forced != NULL)
+    {
+        best = gtmp_find_algo(forced);
+        if (best == NULL)
+            fprintf(stderr, "GTMP_BARRIER=%s is not a known barrier, tuning instead\n", forced);
+        else
+            return best;
+    }
+
+    gethostname(host, sizeof(host));
+    host[sizeof(host) - 1] = '\0';
+    gttune_local_topology(topology, sizeof(topology));
+    gttune_key(key, sizeof(key), host, "omp", num_threads, topology);
+    if (gttune_lookup(key, cached, sizeof(cached)) && (best = gtmp_find_algo(cached)) != NULL)
+        return best;
+
+    for (int i = 0; i < gtmp_num_algos; i++)
+    {
+        double ns = calibrate(&gtmp_algos[i], num_threads);
+        if (best == NULL || ns < best_ns)
+        {
+            best = &gtmp_algos[i];
+            best_ns = ns;
+        }
+    }
+    gttune_store(key, best->name);
+    return best;
+}
+
+void gtmp_init(int num_threads){
+    if (current == NULL || tuned_P != num_threads)
+    {
+        current = choose(num_threads);
+        tuned_P = num_threads;
+        printf("gtmp_auto: %d threads -> %s barrier\n", num_threads, current->name);
+    }
+    current->init(num_threads);
+}
+
+void gtmp_barrier(){
+    current->barrier();
+}
+
+void gtmp_finalize(){
+    current->finalize();
+}
@@ -0,0 +1,517 @@
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <unistd.h>
+#include "gtmp.h"
+#include "gtcheck.h"
+#include "gtspin.h"
+#include "gtstats.h"
+#ifdef GTMP_CHECK_STEAL
+#include "gtmp_steal.h"
+#endif
+#ifdef GTMP_CHECK_PHASER
+#include "gtmp_phaser.h"
+#endif
+#ifdef GTMP_CHECK_EPOCH
+#include "gtmp_epoch.h"
+#endif
+
+/*
+    Stress and regression check for one OpenMP barrier (mp1_check ..
+    mp6_check, each linked against the barrier of the matching mpN, run by
+    make check). See gtcheck.h.
+
+    Teams larger than the online CPUs are oversubscribed on purpose. The
+    barriers that wait through gtspin (all but mp3) then spin with
+    sched_yield whatever GT_SPIN says, or every round would cost a
+    scheduler quantum; other teams use GT_SPIN as given. mp3's
+    #pragma omp barrier waits however the OpenMP runtime does
+    (OMP_WAIT_POLICY), which the check leaves alone.
+
+    Usage: ./mpN_check [-p max_threads] [-e episodes] [-w workload]
+                       [-t teams] [-n episodes] [-b baseline] [-s slack] [-r]
+        -p -e -w    stress: teams of 1..max_threads (default 64), episodes
+                    each (default 200, 0 skips it), delays from workload
+                    (default pareto:2000:1.5)
+        -t -n       regression: median over n episodes (default 4000) per
+                    run on each team of the list (default 4,8 threads)
+        -b -s       baseline file (default check.baseline.<host>), slack
+                    (1.5, 0 skips the regression)
+        -r          only measure, and print the baseline lines
+
+    Barriers with more API than gtmp_barrier get a stress case of their
+    own, built in with a -DGTMP_CHECK_<API> flag (see the Makefile):
+        STEAL       mp4: every thread spawns nested tasks before the
+                    barrier, and no thread may leave before all have run
+        PHASER      mp5: threads deregister and register again between
+                    phases, and every phase must hold all its arrivals
+        EPOCH       mp6: split-phase episodes (arrive, work, wait), and a
+                    timed wait that has to time out while one thread is
+                    held back, then see the release once it arrives
+*/
+typedef struct{
+    int count;        // episodes some thread left early
+    int P;            // the first of them
+    int episode;
+    int thread;
+    int arrived;
+} early_t;
+
+static void stress(int P, int episodes, const gtwork_t *work, int *arrivals, early_t *early){
+    for (int e = 0; e < episodes; e++)
+        arrivals[e] = 0;
+
+    gtmp_init(P);
+    #pragma omp parallel num_threads(P)
+    {
+        int me = omp_get_thread_num();
+        for (int e = 0; e < episodes; e++)
+        {
+            gtcheck_delay(work, me, P, e);
+            // relaxed on both sides: the barrier itself has to publish the arrivals
+            __atomic_fetch_add(&arrivals[e], 1, __ATOMIC_RELAXED);
+            gtmp_barrier();
+            int arrived = __atomic_load_n(&arrivals[e], __ATOMIC_RELAXED);
+            if (arrived != P)
+            {
+                #pragma omp critical
+                {
+                    if (early->count++ == 0)
+                        *early = (early_t){ 1, P, e, me, arrived };
+                }
+            }
+        }
+    }
+    gtmp_finalize();
+}
+
+#ifdef GTMP_CHECK_STEAL
+/*
+    Every thread spawns TASK_ROOTS trees of depth TASK_DEPTH (each task
+    spawns two children), each task as long as the thread's workload draw,
+    then works through its own stress delay before it arrives, so the
+    threads already waiting steal the trees and are still running their
+    tasks when the last thread arrives.
+    Each task bumps the episode's counter when it has spawned its
+    children; after the barrier every thread must see all of them.
+*/
+#define TASK_ROOTS 2
+#define TASK_DEPTH 2
+#define TASKS_PER_THREAD (TASK_ROOTS * ((1 << (TASK_DEPTH + 1)) - 1))
+
+typedef struct{
+    int *done;
+    int depth;
+    uint64_t ns;
+} task_arg_t;
+
+static void task(void *p){
+    task_arg_t *arg = (task_arg_t*)p;
+
+    gtwork_spin(arg->ns);
+    for (int i = 0; arg->depth > 0 && i < 2; i++)
+    {
+        task_arg_t *child = (task_arg_t*)malloc(sizeof(task_arg_t));
+        *child = (task_arg_t){ arg->done, arg->depth - 1, arg->ns };
+        gtmp_spawn(task, child);
+    }
+    __atomic_fetch_add(arg->done, 1, __ATOMIC_RELAXED);
+    free(arg);
+}
+
+static void stress_tasks(int P, int episodes, const gtwork_t *work, int *done, early_t *early){
+    for (int e = 0; e < episodes; e++)
+        done[e] = 0;
+
+    gtmp_init(P);
+    #pragma omp parallel num_threads(P)
+    {
+        int me = omp_get_thread_num();
+        for (int e = 0; e < episodes; e++)
+        {
+            uint64_t ns = gtwork_ns(work, me, P, e);
+            for (int r = 0; r < TASK_ROOTS; r++)
+            {
+                task_arg_t *root = (task_arg_t*)malloc(sizeof(task_arg_t));
+                *root = (task_arg_t){ &done[e], TASK_DEPTH, ns };
+                gtmp_spawn(task, root);
+            }
+            gtcheck_delay(work, me, P, e); // the waiting threads steal meanwhile
+            gtmp_barrier();
+            int ran = __atomic_load_n(&done[e], __ATOMIC_RELAXED);
+            if (ran != P * TASKS_PER_THREAD)
+            {
+                #pragma omp critical
+                {
+                    if (early->count++ == 0)
+                        *early = (early_t){ 1, P, e, me, ran };
+                }
+            }
+        }
+    }
+    gtmp_finalize();
+}
+
+static int check_tasks(const char *name, int max_threads, int episodes, const gtwork_t *work, int cpus, enum gtspin_policy policy){
+    int *done = (int*)malloc(episodes * sizeof(int));
+    early_t early = {0};
+    char what[128];
+
+    for (int P = 1; P <= max_threads; P++)
+    {
+        snprintf(what, sizeof(what), "%s: task stress on %d threads", name, P);
+        gtcheck_watchdog(what, GTCHECK_TIMEOUT);
+        gtspin_policy = P > cpus ? gtspin_yield : policy;
+        stress_tasks(P, episodes, work, done, &early);
+    }
+    gtcheck_watchdog(NULL, 0);
+    gtspin_policy = policy;
+    free(done);
+
+    if (early.count > 0)
+    {
+        printf("%s: tasks 1-%d threads x %d episodes x %d tasks (%s): FAILED, %d early releases;"
+               " first on %d threads, episode %d: thread %d left with %d of %d tasks run\n",
+            name, max_threads, episodes, TASKS_PER_THREAD, work->spec, early.count, early.P, early.episode,
+            early.thread, early.arrived, early.P * TASKS_PER_THREAD);
+        return 1;
+    }
+    printf("%s: tasks 1-%d threads x %d episodes x %d tasks (%s): ok\n", name, max_threads, episodes, TASKS_PER_THREAD, work->spec);
+    return 0;
+}
+#endif
+
+#ifdef GTMP_CHECK_PHASER
+/*
+    Every thread but 0 leaves the phaser now and then (deregister arrives
+    on its phase and leaves) and joins again after a stress delay, on
+    whatever phase register returns. Each party counts its arrival on the
+    phase it expects, and its arrive must return that phase. After await
+    it records the count it saw; at the end every phase's smallest seen
+    count must equal all arrivals on it.
+*/
+static int leaves(int thread, unsigned int phase){
+    return thread != 0 && ((thread * 2654435761u) ^ (phase * 40503u)) % 5 == 0;
+}
+
+static void stress_membership(int P, int episodes, const gtwork_t *work, int *arrivals, int *seen, early_t *early, int *misplaced){
+    for (int e = 0; e < episodes; e++)
+    {
+        arrivals[e] = 0;
+        seen[e] = INT_MAX;
+    }
+
+    gtmp_init(P);
+    #pragma omp parallel num_threads(P)
+    {
+        int me = omp_get_thread_num();
+        unsigned int phase = 0, left = -1;
+
+        while (phase < (unsigned int)episodes)
+        {
+            gtcheck_delay(work, me, P, phase);
+            __atomic_fetch_add(&arrivals[phase], 1, __ATOMIC_RELAXED);
+            if (leaves(me, phase) && phase != left) // once: it may rejoin the phase it left
+            {
+                left = phase;
+                if (gtmp_phaser_deregister() != phase)
+                    __atomic_fetch_add(misplaced, 1, __ATOMIC_RELAXED);
+                gtcheck_delay(work, me, P, phase + episodes);
+                phase = gtmp_phaser_register(); // may be the phase just left
+                continue;
+            }
+            if (gtmp_phaser_arrive() != phase)
+                __atomic_fetch_add(misplaced, 1, __ATOMIC_RELAXED);
+            gtmp_phaser_await(phase + 1);
+
+            int arrived = __atomic_load_n(&arrivals[phase], __ATOMIC_RELAXED);
+            int least = __atomic_load_n(&seen[phase], __ATOMIC_RELAXED);
+            while (arrived < least && !__atomic_compare_exchange_n(&seen[phase], &least, arrived, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+            phase++;
+        }
+    }
+    gtmp_finalize();
+
+    for (int e = 0; e < episodes; e++)
+    {
+        if (seen[e] < arrivals[e] && early->count++ == 0)
+            *early = (early_t){ 1, P, e, -1, seen[e] };
+    }
+}
+
+static int check_membership(const char *name, int max_threads, int episodes, const gtwork_t *work, int cpus, enum gtspin_policy policy){
+    int *arrivals = (int*)malloc(episodes * sizeof(int));
+    int *seen = (int*)malloc(episodes * sizeof(int));
+    early_t early = {0};
+    int misplaced = 0;
+    char what[128];
+
+    for (int P = 1; P <= max_threads; P++)
+    {
+        snprintf(what, sizeof(what), "%s: membership stress on %d threads", name, P);
+        gtcheck_watchdog(what, GTCHECK_TIMEOUT);
+        gtspin_policy = P > cpus ? gtspin_yield : policy;
+        stress_membership(P, episodes, work, arrivals, seen, &early, &misplaced);
+    }
+    gtcheck_watchdog(NULL, 0);
+    gtspin_policy = policy;
+    free(arrivals);
+    free(seen);
+
+    if (early.count > 0 || misplaced > 0)
+    {
+        printf("%s: membership 1-%d threads x %d phases (%s): FAILED, %d early releases, %d arrivals on an unexpected phase",
+            name, max_threads, episodes, work->spec, early.count, misplaced);
+        if (early.count > 0)
+            printf("; first on %d threads, phase %d: a party left with %d arrived", early.P, early.episode, early.arrived);
+        printf("\n");
+        return 1;
+    }
+    printf("%s: membership 1-%d threads x %d phases (%s): ok\n", name, max_threads, episodes, work->spec);
+    return 0;
+}
+#endif
+
+#ifdef GTMP_CHECK_EPOCH
+#define HELD_EPISODES 5
+#define HELD_TIMEOUT_NS 1000000ull         // 1 ms: has to expire
+#define RELEASE_TIMEOUT_NS 60000000000ull  // 60 s: has to see the release
+
+// the stress run with the work between arrive and wait instead of before the arrival
+static void stress_split(int P, int episodes, const gtwork_t *work, int *arrivals, early_t *early){
+    for (int e = 0; e < episodes; e++)
+        arrivals[e] = 0;
+
+    gtmp_init(P);
+    #pragma omp parallel num_threads(P)
+    {
+        int me = omp_get_thread_num();
+        for (int e = 0; e < episodes; e++)
+        {
+            __atomic_fetch_add(&arrivals[e], 1, __ATOMIC_RELAXED);
+            uint64_t epoch = gtmp_epoch_arrive();
+            gtcheck_delay(work, me, P, e);
+            gtmp_epoch_wait(epoch);
+            int arrived = __atomic_load_n(&arrivals[e], __ATOMIC_RELAXED);
+            if (arrived != P)
+            {
+                #pragma omp critical
+                {
+                    if (early->count++ == 0)
+                        *early = (early_t){ 1, P, e, me, arrived };
+                }
+            }
+        }
+    }
+    gtmp_finalize();
+}
+
+/*
+    Every episode one thread (rotating) holds back until all the others
+    have seen a short timed wait expire on the episode's epoch; then it
+    arrives, and the others' second, long timed wait must see the release.
+*/
+static void stress_timeout(int P, int *expired, int *premature, int *missed){
+    for (int e = 0; e < HELD_EPISODES; e++)
+        expired[e] = 0;
+
+    gtmp_init(P);
+    #pragma omp parallel num_threads(P)
+    {
+        int me = omp_get_thread_num();
+        for (int e = 0; e < HELD_EPISODES; e++)
+        {
+            if (me == e % P)
+            {
+                while (__atomic_load_n(&expired[e], __ATOMIC_ACQUIRE) < P - 1)
+                    gtspin_poll();
+                gtmp_epoch_wait(gtmp_epoch_arrive());
+                continue;
+            }
+            uint64_t epoch = gtmp_epoch_arrive();
+            if (gtmp_epoch_timed_wait(epoch, HELD_TIMEOUT_NS))
+                __atomic_fetch_add(premature, 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&expired[e], 1, __ATOMIC_RELEASE);
+            if (!gtmp_epoch_timed_wait(epoch, RELEASE_TIMEOUT_NS))
+                __atomic_fetch_add(missed, 1, __ATOMIC_RELAXED);
+        }
+    }
+    gtmp_finalize();
+}
+
+static int check_epoch(const char *name, int max_threads, int episodes, const gtwork_t *work, int cpus, enum gtspin_policy policy){
+    int *arrivals = (int*)malloc(episodes * sizeof(int));
+    int expired[HELD_EPISODES], premature = 0, missed = 0, failed = 0;
+    early_t early = {0};
+    char what[128];
+
+    for (int P = 1; P <= max_threads; P++)
+    {
+        snprintf(what, sizeof(what), "%s: split-phase stress on %d threads", name, P);
+        gtcheck_watchdog(what, GTCHECK_TIMEOUT);
+        gtspin_policy = P > cpus ? gtspin_yield : policy;
+        stress_split(P, episodes, work, arrivals, &early);
+    }
+    for (int P = 2; P <= max_threads; P++)
+    {
+        snprintf(what, sizeof(what), "%s: timed wait on %d threads", name, P);
+        gtcheck_watchdog(what, GTCHECK_TIMEOUT);
+        gtspin_policy = P > cpus ? gtspin_yield : policy;
+        stress_timeout(P, expired, &premature, &missed);
+    }
+    gtcheck_watchdog(NULL, 0);
+    gtspin_policy = policy;
+    free(arrivals);
+
+    if (early.count > 0)
+    {
+        printf("%s: split-phase 1-%d threads x %d episodes (%s): FAILED, %d early departures;"
+               " first on %d threads, episode %d: thread %d left with %d of %d arrived\n",
+            name, max_threads, episodes, work->spec, early.count, early.P, early.episode, early.thread, early.arrived, early.P);
+        failed = 1;
+    }
+    else
+        printf("%s: split-phase 1-%d threads x %d episodes (%s): ok\n", name, max_threads, episodes, work->spec);
+
+    if (premature > 0 || missed > 0)
+    {
+        printf("%s: timed wait 2-%d threads x %d episodes: FAILED, %d returned the epoch before the held-back thread arrived,"
+               " %d timed out after it arrived\n", name, max_threads, HELD_EPISODES, premature, missed);
+        failed = 1;
+    }
+    else
+        printf("%s: timed wait 2-%d threads x %d episodes: ok\n", name, max_threads, HELD_EPISODES);
+    return failed;
+}
+#endif
+
+static double median_latency(int P, int episodes){
+    gtstats_hist_t *hists = (gtstats_hist_t*)malloc(P * sizeof(gtstats_hist_t));
+    gtstats_hist_t all;
+
+    gtmp_init(P);
+    #pragma omp parallel num_threads(P)
+    {
+        int me = omp_get_thread_num();
+        gtstats_hist_init(&hists[me]);
+        for (int e = 0; e < episodes / 10; e++) // warm-up
+            gtmp_barrier();
+        for (int e = 0; e < episodes; e++)
+        {
+            uint64_t arrive = gtstats_now();
+            gtmp_barrier();
+            gtstats_hist_record(&hists[me], gtstats_now() - arrive);
+        }
+    }
+    gtmp_finalize();
+
+    gtstats_hist_init(&all);
+    for (int t = 0; t < P; t++)
+        gtstats_hist_merge(&all, &hists[t]);
+    free(hists);
+    return gtstats_hist_percentile(&all, 50);
+}
+
+int main(int argc, char **argv){
+    const char *name = gtcheck_basename(argv[0]);
+    char default_baseline[512];
+    const char *baseline = default_baseline, *spec = GTCHECK_WORK;
+    const char *team_list = GTCHECK_TEAMS;
+    int max_threads = 64, episodes = 200, perf_episodes = 4000, record = 0, opt;
+    int cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int teams[GTCHECK_TEAMS_MAX], n_teams;
+    double slack = GTCHECK_SLACK;
+    gtwork_t work;
+
+    gtcheck_baseline_path(default_baseline, sizeof(default_baseline));
+    while ((opt = getopt(argc, argv, "p:e:w:t:n:b:s:r")) != -1)
+    {
+        switch (opt)
+        {
+            case 'p': max_threads = strtol(optarg, NULL, 10); break;
+            case 'e': episodes = strtol(optarg, NULL, 10); break;
+            case 'w': spec = optarg; break;
+            case 't': team_list = optarg; break;
+            case 'n': perf_episodes = strtol(optarg, NULL, 10); break;
+            case 'b': baseline = optarg; break;
+            case 's': slack = strtod(optarg, NULL); break;
+            case 'r': record = 1; break;
+            default:
+                fprintf(stderr, "Usage: %s [-p max_threads] [-e episodes] [-w workload] [-t teams] [-n episodes] [-b baseline] [-s slack] [-r]\n", argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    n_teams = gtcheck_teams(team_list, teams);
+    if (max_threads < 1 || episodes < 0 || n_teams == 0 || perf_episodes < 10 || slack < 0 || !gtwork_parse(&work, spec))
+    {
+        fprintf(stderr, "%s: bad -p, -e, -t, -n or -w\n", name);
+        exit(EXIT_FAILURE);
+    }
+
+    omp_set_dynamic(0);
+    gtspin_init();
+    enum gtspin_policy policy = gtspin_policy;
+    char team[GTCHECK_TEAM_MAX], what[128];
+    int failed = 0;
+
+    if (!record && episodes > 0)
+    {
+        int *arrivals = (int*)malloc(episodes * sizeof(int));
+        early_t early = {0};
+
+        for (int P = 1; P <= max_threads; P++)
+        {
+            snprintf(what, sizeof(what), "%s: stress on %d threads", name, P);
+            gtcheck_watchdog(what, GTCHECK_TIMEOUT);
+            gtspin_policy = P > cpus ? gtspin_yield : policy;
+            stress(P, episodes, &work, arrivals, &early);
+        }
+        gtcheck_watchdog(NULL, 0);
+        gtspin_policy = policy;
+        free(arrivals);
+
+        if (early.count > 0)
+        {
+            printf("%s: stress 1-%d threads x %d episodes (%s): FAILED, %d early departures;"
+                   " first on %d threads, episode %d: thread %d left with %d of %d arrived\n",
+                name, max_threads, episodes, work.spec, early.count, early.P, early.episode, early.thread, early.arrived, early.P);
+            failed = 1;
+        }
+        else
+            printf("%s: stress 1-%d threads x %d episodes (%s): ok\n", name, max_threads, episodes, work.spec);
+#ifdef GTMP_CHECK_STEAL
+        failed |= check_tasks(name, max_threads, episodes, &work, cpus, policy);
+#endif
+#ifdef GTMP_CHECK_PHASER
+        failed |= check_membership(name, max_threads, episodes, &work, cpus, policy);
+#endif
+#ifdef GTMP_CHECK_EPOCH
+        failed |= check_epoch(name, max_threads, episodes, &work, cpus, policy);
+#endif
+    }
+
+    for (int i = 0; (record || slack > 0) && i < n_teams; i++)
+    {
+        int P = teams[i];
+
+        snprintf(what, sizeof(what), "%s: regression on %d threads", name, P);
+        gtcheck_watchdog(what, GTCHECK_TIMEOUT);
+        gtspin_policy = P > cpus ? gtspin_yield : policy;
+        double median = median_latency(P, perf_episodes);
+        for (int r = 1; r < GTCHECK_REPEATS; r++)
+        {
+            double again = median_latency(P, perf_episodes);
+            if (again < median)
+                median = again;
+        }
+        gtcheck_watchdog(NULL, 0);
+        snprintf(team, sizeof(team), "%d", P);
+
+        if (record)
+            gtcheck_record(stdout, name, team, median);
+        else
+            failed |= gtcheck_regression(stdout, baseline, name, team, median, slack);
+    }
+    return failed;
+}
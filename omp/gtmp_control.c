@@ -1,9 +1,26 @@
-#include <omp.h>
 #include "gtmp.h"
 
 /*
-    Control barrier (OpenMP)
+    Control barrier: the runtime's own, #pragma omp barrier for OpenMP
+    and pthread_barrier_wait for the pthreads build
 */
+#ifdef GTMP_PTHREADS
+#include <pthread.h>
+
+static pthread_barrier_t control;
+
+void gtmp_init(int num_threads){
+    pthread_barrier_init(&control, NULL, num_threads);
+}
+
+void gtmp_barrier(){
+    pthread_barrier_wait(&control);
+}
+
+void gtmp_finalize(){
+    pthread_barrier_destroy(&control);
+}
+#else
 
 void gtmp_init(int num_threads){
 }
@@ -13,4 +30,5 @@ void gtmp_barrier(){
 }
 
 void gtmp_finalize(){
-}
\ No newline at end of file
+}
+#endif
@@ -0,0 +1,30 @@
+#include <stdint.h>
+
+#ifndef GTMP_EPOCH_H
+#define GTMP_EPOCH_H
+
+/*
+    Epoch barrier (gtmp6.c, mp6).
+
+    The barrier's state is a 64-bit generation that only ever increases,
+    so an epoch never repeats and there is no sense to flip. Split-phase:
+        gtmp_epoch_arrive          arrive without waiting; returns the epoch
+                                   the current episode completes into
+        gtmp_epoch_wait            block until the generation is >= epoch
+        gtmp_epoch_timed_wait      the same with a timeout in nanoseconds;
+                                   returns 1 if the epoch was reached, 0 on
+                                   timeout
+        gtmp_barrier               gtmp_epoch_wait(gtmp_epoch_arrive())
+    Any thread may wait for any epoch, including ones several episodes
+    ahead. A participant must wait for its last arrival before arriving
+    again. Waiters poll GTMP_EPOCH_SPINS times (gtspin_poll: pause, or
+    sched_yield under GT_SPIN=yield) and then sleep on a futex.
+*/
+#define GTMP_EPOCH_SPINS 4096
+
+uint64_t gtmp_epoch_arrive(void);
+void gtmp_epoch_wait(uint64_t epoch);
+int gtmp_epoch_timed_wait(uint64_t epoch, uint64_t timeout_ns);
+uint64_t gtmp_epoch_current(void);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef GTMP_PHASER_H
+#define GTMP_PHASER_H
+
+/*
+    Dynamic-membership phaser (gtmp5.c, mp5).
+
+    gtmp_init(P) registers P parties for phase 0; after that the number of
+    parties changes one thread at a time, without re-initializing:
+        gtmp_phaser_register     the calling thread joins the current phase
+                                 (it has to arrive on it like everyone else)
+        gtmp_phaser_deregister   arrive on the current phase and leave; the
+                                 next phase counts one party less
+    A phase completes when all its parties have arrived:
+        gtmp_phaser_arrive       arrive without waiting, returns the phase
+                                 arrived on (split-phase: do other work, then
+                                 gtmp_phaser_await(phase + 1))
+        gtmp_phaser_await        wait until the phase number is at least the
+                                 given one; any thread may wait for any
+                                 future phase, registered or not
+        gtmp_barrier             arrive and wait for the next phase
+    Phase numbers are 32-bit and compared modulo 2^32.
+*/
+#define GTMP_PHASER_MAX_PARTIES 0xffff
+
+unsigned int gtmp_phaser_register(void);   // returns the phase joined
+unsigned int gtmp_phaser_deregister(void); // returns the phase left on
+unsigned int gtmp_phaser_arrive(void);
+void gtmp_phaser_await(unsigned int phase);
+unsigned int gtmp_phaser_phase(void);
+int gtmp_phaser_parties(void);
+
+#endif
@@ -0,0 +1,11 @@
+#include "gtmp.h"
+
+/*
+    Thread identity for the pthreads build (see gtmp.h). The thread that
+    never registers, e.g. main, is thread 0.
+*/
+__thread int gtmp_thread_id = 0;
+
+void gtmp_thread_register(int thread_id){
+    gtmp_thread_id = thread_id;
+}
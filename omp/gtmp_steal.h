@@ -0,0 +1,22 @@
+#ifndef GTMP_STEAL_H
+#define GTMP_STEAL_H
+
+/*
+    Tasks for the work-stealing barrier (gtmp4.c, mp4).
+
+    gtmp_spawn queues fn(arg) on the calling thread's deque. The task is
+    tagged "may run before the barrier completes": it runs at the latest
+    in the spawning thread's next gtmp_barrier, and earlier if a thread
+    that is already waiting in the barrier steals it. gtmp_barrier only
+    returns once every task spawned before it, and every task those tasks
+    spawn, has finished. Tasks must not call gtmp_barrier.
+
+    A full deque (GTMP_STEAL_CAPACITY tasks) runs the task inline instead.
+*/
+#define GTMP_STEAL_CAPACITY 1024 // per thread, a power of two
+
+typedef void (*gtmp_task_fn)(void *arg);
+
+void gtmp_spawn(gtmp_task_fn fn, void *arg);
+
+#endif
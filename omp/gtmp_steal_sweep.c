@@ -0,0 +1,201 @@
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "gtmp.h"
+#include "gtmp_steal.h"
+#include "gtstats.h"
+#include "gtsweep.h"
+#include "gtwork.h"
+
+/*
+    How much of a load imbalance the work-stealing barrier (gtmp4.c)
+    recovers (mp_steal). For every thread count, workload and task count
+    the same episodes run twice on mp4's barrier:
+        inline      every thread runs its workload draw, then arrives
+        spawned     every thread splits its draw into tasks chunks,
+                    gtmp_spawn()s them and arrives; threads that arrive
+                    early steal the chunks of the slow ones
+    The imbalance of a point is the mean over its episodes of the longest
+    draw minus the mean draw: what a perfectly balanced split would save.
+    recovered = (inline - spawned) / imbalance, the fraction of it that
+    stealing gets back (negative when spawning costs more than it saves).
+
+    Usage: ./mp_steal [-t threads] [-w workload,...] [-k tasks,...]
+                      [-r reps] [-e episodes] [-o file]
+    Defaults: every thread count from 2 up to the online CPUs (at least
+    2), straggler:10000:100000:10, 8 tasks per thread, 10 repetitions of
+    1000 episodes, CSV on stdout:
+        P,workload,tasks,reps,episodes,inline_ns,inline_ci95,
+        spawned_ns,spawned_ci95,imbalance_ns,recovered
+*/
+typedef struct{
+    uint64_t ns[GTSWEEP_MAX_LIST]; // one chunk per task, reused every episode
+    char pad[64];
+} chunks_t;
+
+static void chunk(void *arg){
+    gtwork_spin(*(uint64_t*)arg);
+}
+
+// wall time per episode over count episodes numbered from first; tasks 0 runs the work inline
+static double run_episodes(int P, const gtwork_t *work, int tasks, uint64_t first, int count, chunks_t *chunks){
+    uint64_t start = 0, end = 0;
+
+    #pragma omp parallel num_threads(P)
+    {
+        int me = omp_get_thread_num();
+
+        gtmp_barrier(); // line everybody up before the clock starts
+        #pragma omp master
+        start = gtstats_now();
+        for (int i = 0; i < count; i++)
+        {
+            if (tasks == 0)
+                gtwork_run(work, me, P, first + i);
+            else
+            {
+                uint64_t ns = gtwork_ns(work, me, P, first + i);
+                for (int k = 0; k < tasks; k++)
+                {
+                    chunks[me].ns[k] = ns / tasks;
+                    gtmp_spawn(chunk, &chunks[me].ns[k]); // the barrier returns only once every chunk ran
+                }
+            }
+            gtmp_barrier();
+        }
+        #pragma omp master
+        end = gtstats_now();
+    }
+    return (double)(end - start) / count;
+}
+
+static double imbalance_ns(int P, const gtwork_t *work, int episodes){
+    double total = 0;
+
+    for (int e = 0; e < episodes; e++)
+    {
+        double longest = 0, sum = 0;
+        for (int t = 0; t < P; t++)
+        {
+            double ns = gtwork_ns(work, t, P, e);
+            sum += ns;
+            if (ns > longest)
+                longest = ns;
+        }
+        total += longest - sum / P;
+    }
+    return total / episodes;
+}
+
+static void run_point(FILE *out, int P, const gtwork_t *work, int tasks, int reps, int episodes){
+    chunks_t *chunks = (chunks_t*)malloc(P * sizeof(chunks_t));
+    double *inline_ns = (double*)malloc(reps * sizeof(double));
+    double *spawned_ns = (double*)malloc(reps * sizeof(double));
+
+    gtmp_init(P);
+    run_episodes(P, work, 0, 0, episodes, chunks); // warm-up, both ways
+    run_episodes(P, work, tasks, 0, episodes, chunks);
+    for (int r = 0; r < reps; r++) // the same episodes both ways
+    {
+        inline_ns[r] = run_episodes(P, work, 0, (uint64_t)r * episodes, episodes, chunks);
+        spawned_ns[r] = run_episodes(P, work, tasks, (uint64_t)r * episodes, episodes, chunks);
+    }
+    gtmp_finalize();
+
+    gtsweep_summary_t inlined = gtsweep_summarize(inline_ns, reps);
+    gtsweep_summary_t spawned = gtsweep_summarize(spawned_ns, reps);
+    double imbalance = imbalance_ns(P, work, reps * episodes);
+    fprintf(out, "%d,%s,%d,%d,%d,%.1f,%.1f,%.1f,%.1f,%.1f,", P, work->spec, tasks, reps, episodes,
+        inlined.mean, inlined.ci95, spawned.mean, spawned.ci95, imbalance);
+    if (imbalance > 0)
+        fprintf(out, "%.3f\n", (inlined.mean - spawned.mean) / imbalance);
+    else
+        fprintf(out, "\n"); // balanced workload: nothing to recover
+    fflush(out);
+
+    free(chunks);
+    free(inline_ns);
+    free(spawned_ns);
+}
+
+int main(int argc, char **argv){
+    char default_threads[32];
+    char *threads = default_threads, *workloads = "straggler:10000:100000:10", *task_counts = "8", *path = NULL;
+    int reps = 10, episodes = 1000, opt;
+    int thread_list[GTSWEEP_MAX_LIST], task_list[GTSWEEP_MAX_LIST];
+    gtwork_t work_list[GTSWEEP_MAX_LIST];
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    snprintf(default_threads, sizeof(default_threads), "2-%ld", cpus > 2 ? cpus : 2);
+    while ((opt = getopt(argc, argv, "t:w:k:r:e:o:")) != -1)
+    {
+        switch (opt)
+        {
+            case 't': threads = optarg; break;
+            case 'w': workloads = optarg; break;
+            case 'k': task_counts = optarg; break;
+            case 'r': reps = strtol(optarg, NULL, 10); break;
+            case 'e': episodes = strtol(optarg, NULL, 10); break;
+            case 'o': path = optarg; break;
+            default:
+                fprintf(stderr, "Usage: %s [-t threads] [-w workload,...] [-k tasks,...] [-r reps] [-e episodes] [-o file]\n", argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    int n_threads = gtsweep_parse_list(threads, thread_list, GTSWEEP_MAX_LIST);
+    int n_tasks = gtsweep_parse_list(task_counts, task_list, GTSWEEP_MAX_LIST);
+    if (n_threads == 0 || n_tasks == 0 || reps < 1 || episodes < 1)
+    {
+        fprintf(stderr, "mp_steal: bad -t, -k, -r or -e\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int t = 0; t < n_threads; t++)
+    {
+        if (thread_list[t] < 1)
+        {
+            fprintf(stderr, "mp_steal: thread counts start at 1\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int k = 0; k < n_tasks; k++)
+    {
+        if (task_list[k] < 1 || task_list[k] > GTSWEEP_MAX_LIST)
+        {
+            fprintf(stderr, "mp_steal: -k takes 1 to %d tasks per thread\n", GTSWEEP_MAX_LIST);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    int n_work = 0;
+    char *specs = strdup(workloads), *save;
+    for (char *spec = strtok_r(specs, ",", &save); spec != NULL && n_work < GTSWEEP_MAX_LIST; spec = strtok_r(NULL, ",", &save))
+    {
+        if (!gtwork_parse(&work_list[n_work++], spec))
+        {
+            fprintf(stderr, "mp_steal: bad workload %s\n", spec);
+            exit(EXIT_FAILURE);
+        }
+    }
+    free(specs);
+
+    FILE *out = path == NULL || strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (out == NULL)
+    {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+    fprintf(out, "P,workload,tasks,reps,episodes,inline_ns,inline_ci95,spawned_ns,spawned_ci95,imbalance_ns,recovered\n");
+
+    omp_set_dynamic(0);
+    for (int t = 0; t < n_threads; t++)
+        for (int w = 0; w < n_work; w++)
+            for (int k = 0; k < n_tasks; k++)
+                run_point(out, thread_list[t], &work_list[w], task_list[k], reps, episodes);
+
+    if (out != stdout)
+        fclose(out);
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "gtmp_algos.h"
+#include "gtstats.h"
+#include "gtsweep.h"
+#include "gtwork.h"
+
+/*
+    In-process sweep over thread counts, algorithms, workloads and
+    episode counts (mp_sweep), replacing the per-count relaunch loops of the sbatch files.
+    See gtsweep.h for the warm-up, repetition and output rules and
+    gtwork.h for the workload specs.
+
+    Usage: ./mp_sweep [-t threads] [-a algo,...] [-w workload,...]
+                      [-r reps] [-e episodes,...] [-f csv|json] [-o file]
+    -t and -e take lists like "2,4,8" or "2-12".
+    Defaults: every thread count up to the online CPUs, every algorithm
+    in gtmp_algos[], no work, 10 repetitions of 1000 episodes, CSV on
+    stdout.
+*/
+typedef struct{
+    double barrier_ns; // summed over this thread's episodes
+    char pad[56];
+} thread_sum_t;
+
+// count episodes on P threads, numbered from *episode; returns the mean barrier time, *wall_ns the wall time per episode
+static double run_episodes(const gtmp_algo_t *algo, int P, const gtwork_t *work, uint64_t *episode, int count,
+                           thread_sum_t *sums, gtstats_hist_t *hists, double *wall_ns){
+    uint64_t first = *episode;
+    uint64_t start = 0, end = 0;
+
+    #pragma omp parallel num_threads(P)
+    {
+        int me = omp_get_thread_num();
+        sums[me].barrier_ns = 0;
+
+        algo->barrier(); // line everybody up before the clock starts
+        #pragma omp master
+        start = gtstats_now();
+        for (int i = 0; i < count; i++)
+        {
+            gtwork_run(work, me, P, first + i);
+            uint64_t arrive = gtstats_now();
+            algo->barrier();
+            uint64_t latency = gtstats_now() - arrive;
+            sums[me].barrier_ns += latency;
+            if (hists != NULL)
+                gtstats_hist_record(&hists[me], latency);
+        }
+        #pragma omp master
+        end = gtstats_now();
+    }
+
+    *episode += count;
+    double total = 0;
+    for (int t = 0; t < P; t++)
+        total += sums[t].barrier_ns;
+    *wall_ns = (double)(end - start) / count;
+    return total / ((double)P * count);
+}
+
+static void run_point(gtsweep_out_t *out, const gtmp_algo_t *algo, int P, const gtwork_t *work, int reps, int episodes){
+    thread_sum_t *sums = (thread_sum_t*)calloc(P, sizeof(thread_sum_t));
+    gtstats_hist_t *hists = (gtstats_hist_t*)malloc(P * sizeof(gtstats_hist_t));
+    double *barrier = (double*)malloc(reps * sizeof(double));
+    double *wall = (double*)malloc(reps * sizeof(double));
+    gtstats_hist_t latency;
+    gtsweep_steady_t steady;
+    double wall_ns;
+    uint64_t episode = 0;
+
+    algo->init(P);
+
+    gtsweep_steady_init(&steady);
+    while (!gtsweep_steady_done(&steady))
+        gtsweep_steady_add(&steady, run_episodes(algo, P, work, &episode, episodes, sums, NULL, &wall_ns));
+
+    for (int t = 0; t < P; t++)
+        gtstats_hist_init(&hists[t]);
+    for (int r = 0; r < reps; r++)
+        barrier[r] = run_episodes(algo, P, work, &episode, episodes, sums, hists, &wall[r]);
+
+    algo->finalize();
+
+    gtstats_hist_init(&latency);
+    for (int t = 0; t < P; t++)
+        gtstats_hist_merge(&latency, &hists[t]);
+
+    gtsweep_row_t row = {
+        .driver = "omp",
+        .algorithm = algo->name,
+        .P = P,
+        .workload = work->spec,
+        .reps = reps,
+        .episodes = episodes,
+        .warmup_batches = steady.batches,
+        .steady = steady.stable >= GTSWEEP_STABLE_BATCHES,
+        .barrier_ns = gtsweep_summarize(barrier, reps),
+        .episode_ns = gtsweep_summarize(wall, reps),
+        .p50_ns = gtstats_hist_percentile(&latency, 50),
+        .p99_ns = gtstats_hist_percentile(&latency, 99),
+    };
+    gtsweep_write(out, &row);
+
+    free(sums);
+    free(hists);
+    free(barrier);
+    free(wall);
+}
+
+int main(int argc, char **argv){
+    char default_threads[32];
+    char *threads = default_threads, *algos = NULL, *workloads = "0", *episodes = "1000", *format = "csv", *path = NULL;
+    int reps = 10, opt;
+    int thread_list[GTSWEEP_MAX_LIST], episode_list[GTSWEEP_MAX_LIST];
+    gtwork_t work_list[GTSWEEP_MAX_LIST];
+
+    snprintf(default_threads, sizeof(default_threads), "1-%ld", sysconf(_SC_NPROCESSORS_ONLN));
+    while ((opt = getopt(argc, argv, "t:a:w:r:e:f:o:")) != -1)
+    {
+        switch (opt)
+        {
+            case 't': threads = optarg; break;
+            case 'a': algos = optarg; break;
+            case 'w': workloads = optarg; break;
+            case 'r': reps = strtol(optarg, NULL, 10); break;
+            case 'e': episodes = optarg; break;
+            case 'f': format = optarg; break;
+            case 'o': path = optarg; break;
+            default:
+                fprintf(stderr, "Usage: %s [-t threads] [-a algo,...] [-w workload,...] [-r reps] [-e episodes,...] [-f csv|json] [-o file]\n", argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    int n_threads = gtsweep_parse_list(threads, thread_list, GTSWEEP_MAX_LIST);
+    int n_episodes = gtsweep_parse_list(episodes, episode_list, GTSWEEP_MAX_LIST);
+    if (n_threads == 0 || n_episodes == 0 || reps < 1)
+    {
+        fprintf(stderr, "mp_sweep: bad -t, -r or -e\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int t = 0; t < n_threads; t++)
+    {
+        if (thread_list[t] < 1)
+        {
+            fprintf(stderr, "mp_sweep: thread counts start at 1\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int e = 0; e < n_episodes; e++)
+    {
+        if (episode_list[e] < 1)
+        {
+            fprintf(stderr, "mp_sweep: episode counts start at 1\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    int n_work = 0;
+    char *specs = strdup(workloads), *save;
+    for (char *spec = strtok_r(specs, ",", &save); spec != NULL; spec = strtok_r(NULL, ",", &save))
+    {
+        if (n_work == GTSWEEP_MAX_LIST)
+        {
+            fprintf(stderr, "mp_sweep: more than %d workloads in -w\n", GTSWEEP_MAX_LIST);
+            exit(EXIT_FAILURE);
+        }
+        if (!gtwork_parse(&work_list[n_work++], spec))
+        {
+            fprintf(stderr, "mp_sweep: bad workload %s\n", spec);
+            exit(EXIT_FAILURE);
+        }
+    }
+    free(specs);
+
+    // resolve the algorithm names before starting, so a typo does not waste a sweep
+    const gtmp_algo_t *selected[GTSWEEP_MAX_LIST];
+    int n_algos = 0;
+    if (algos == NULL)
+    {
+        for (int i = 0; i < gtmp_num_algos; i++)
+            selected[n_algos++] = &gtmp_algos[i];
+    }
+    else
+    {
+        char *copy = strdup(algos), *save;
+        for (char *name = strtok_r(copy, ",", &save); name != NULL; name = strtok_r(NULL, ",", &save))
+        {
+            if (n_algos == GTSWEEP_MAX_LIST)
+            {
+                fprintf(stderr, "mp_sweep: more than %d algorithms in -a\n", GTSWEEP_MAX_LIST);
+                exit(EXIT_FAILURE);
+            }
+            if ((selected[n_algos++] = gtmp_find_algo(name)) == NULL)
+            {
+                fprintf(stderr, "mp_sweep: unknown algorithm %s\n", name);
+                exit(EXIT_FAILURE);
+            }
+        }
+        free(copy);
+    }
+
+    gtsweep_out_t out;
+    if (!gtsweep_open(&out, path, format))
+    {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+
+    omp_set_dynamic(0);
+    for (int t = 0; t < n_threads; t++)
+        for (int a = 0; a < n_algos; a++)
+            for (int w = 0; w < n_work; w++)
+                for (int e = 0; e < n_episodes; e++)
+                    run_point(&out, selected[a], thread_list[t], &work_list[w], reps, episode_list[e]);
+
+    gtsweep_close(&out);
+    return 0;
+}
@@ -0,0 +1,180 @@
+#include "gtmp_trace.h"
+
+#ifdef GTMP_TRACE
+#include <stdio.h>
+#include <stdlib.h>
+#include "gtstats.h"
+
+typedef struct{
+    uint64_t arrive;
+    uint64_t round[GTMP_TRACE_MAX_ROUNDS];
+    uint64_t release;
+} trace_event_t;
+
+// one ring per thread, written only by its owner
+typedef struct{
+    trace_event_t events[GTMP_TRACE_EPISODES];
+    uint64_t head; // episodes recorded since gtmp_trace_init
+} __attribute__((aligned(64))) trace_ring_t;
+
+static trace_ring_t *rings;
+static int n_threads;
+static int n_rounds;
+static int experiment;
+
+// accumulated over every gtmp_init/gtmp_finalize pair
+static gtstats_hist_t arrival_skew;
+static gtstats_hist_t release_propagation;
+static gtstats_hist_t round_latency[GTMP_TRACE_MAX_ROUNDS];
+static uint64_t *last_arrivals; // times each thread was the last to arrive
+static int summary_threads;
+static int registered;
+
+static void trace_summary(){
+    printf("Trace summary (%d threads, ns):\n", summary_threads);
+    gtstats_hist_report(stdout, "  arrival skew (last - first arrival)", &arrival_skew, 0);
+    gtstats_hist_report(stdout, "  release propagation (last release - last arrival)", &release_propagation, 0);
+    for (int r = 0; r < GTMP_TRACE_MAX_ROUNDS; r++)
+    {
+        if (round_latency[r].count == 0)
+            continue;
+        char label[64];
+        snprintf(label, sizeof(label), "  round %d (from previous step)", r);
+        gtstats_hist_report(stdout, label, &round_latency[r], 0);
+    }
+    printf("  last arriver:");
+    for (int t = 0; t < summary_threads; t++)
+    {
+        printf(" t%d=%llu", t, (unsigned long long)last_arrivals[t]);
+    }
+    printf("\n");
+}
+
+void gtmp_trace_init(int num_threads, int rounds){
+    if (!registered)
+    {
+        gtstats_hist_init(&arrival_skew);
+        gtstats_hist_init(&release_propagation);
+        for (int r = 0; r < GTMP_TRACE_MAX_ROUNDS; r++)
+        {
+            gtstats_hist_init(&round_latency[r]);
+        }
+        atexit(trace_summary);
+        registered = 1;
+    }
+
+    if (rings == NULL || num_threads != n_threads)
+    {
+        free(rings);
+        if (posix_memalign((void**)&rings, 64, num_threads * sizeof(trace_ring_t)) != 0)
+        {
+            fprintf(stderr, "gtmp_trace: cannot allocate rings for %d threads\n", num_threads);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (num_threads > summary_threads)
+    {
+        last_arrivals = (uint64_t*)realloc(last_arrivals, num_threads * sizeof(uint64_t));
+        if (last_arrivals == NULL)
+        {
+            fprintf(stderr, "gtmp_trace: cannot allocate the summary for %d threads\n", num_threads);
+            exit(EXIT_FAILURE);
+        }
+        for (int t = summary_threads; t < num_threads; t++)
+        {
+            last_arrivals[t] = 0;
+        }
+        summary_threads = num_threads;
+    }
+
+    n_threads = num_threads;
+    n_rounds = rounds < GTMP_TRACE_MAX_ROUNDS ? rounds : GTMP_TRACE_MAX_ROUNDS;
+    for (int t = 0; t < n_threads; t++)
+    {
+        rings[t].head = 0;
+    }
+}
+
+void gtmp_trace_arrive(int thread_id){
+    if ((unsigned)thread_id >= (unsigned)n_threads)
+        return;
+    trace_ring_t *ring = &rings[thread_id];
+    ring->events[ring->head % GTMP_TRACE_EPISODES].arrive = gtstats_now();
+}
+
+void gtmp_trace_round(int thread_id, int round){
+    if ((unsigned)thread_id >= (unsigned)n_threads)
+        return;
+    trace_ring_t *ring = &rings[thread_id];
+    if (round < GTMP_TRACE_MAX_ROUNDS)
+        ring->events[ring->head % GTMP_TRACE_EPISODES].round[round] = gtstats_now();
+}
+
+void gtmp_trace_release(int thread_id){
+    if ((unsigned)thread_id >= (unsigned)n_threads)
+        return;
+    trace_ring_t *ring = &rings[thread_id];
+    ring->events[ring->head % GTMP_TRACE_EPISODES].release = gtstats_now();
+    ring->head++;
+}
+
+void gtmp_trace_finalize(){
+    char *path = getenv("GTMP_TRACE_FILE");
+    FILE *dump = path != NULL ? fopen(path, "a") : NULL;
+
+    // every thread passes every episode, so the rings line up by episode number
+    uint64_t episodes = rings[0].head;
+    for (int t = 1; t < n_threads; t++)
+    {
+        if (rings[t].head < episodes)
+            episodes = rings[t].head;
+    }
+    uint64_t first = episodes > GTMP_TRACE_EPISODES ? episodes - GTMP_TRACE_EPISODES : 0;
+
+    for (uint64_t e = first; e < episodes; e++)
+    {
+        int slot = e % GTMP_TRACE_EPISODES;
+        uint64_t first_arrive = UINT64_MAX, last_arrive = 0, last_release = 0;
+        int last = 0;
+
+        for (int t = 0; t < n_threads; t++)
+        {
+            trace_event_t *ev = &rings[t].events[slot];
+            if (ev->arrive < first_arrive)
+                first_arrive = ev->arrive;
+            if (ev->arrive >= last_arrive)
+            {
+                last_arrive = ev->arrive;
+                last = t;
+            }
+            if (ev->release > last_release)
+                last_release = ev->release;
+
+            uint64_t previous = ev->arrive;
+            for (int r = 0; r < n_rounds; r++)
+            {
+                gtstats_hist_record(&round_latency[r], ev->round[r] - previous);
+                previous = ev->round[r];
+            }
+
+            if (dump != NULL)
+            {
+                fprintf(dump, "%d,%d,%llu,%llu", experiment, t, (unsigned long long)e, (unsigned long long)ev->arrive);
+                for (int r = 0; r < n_rounds; r++)
+                {
+                    fprintf(dump, ",%llu", (unsigned long long)ev->round[r]);
+                }
+                fprintf(dump, ",%llu\n", (unsigned long long)ev->release);
+            }
+        }
+
+        gtstats_hist_record(&arrival_skew, last_arrive - first_arrive);
+        gtstats_hist_record(&release_propagation, last_release - last_arrive);
+        last_arrivals[last]++;
+    }
+
+    if (dump != NULL)
+        fclose(dump);
+    experiment++;
+}
+#endif
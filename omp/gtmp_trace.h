@@ -0,0 +1,39 @@
+#include <stdint.h>
+
+#ifndef GTMP_TRACE_H
+#define GTMP_TRACE_H
+
+/*
+    Arrival/release tracing for the OpenMP barriers (build with TRACE=1).
+
+    Each thread owns a ring of the last GTMP_TRACE_EPISODES episodes and is
+    its only writer, so recording takes no locks. Per episode it keeps:
+        arrive      - gtmp_barrier() entered
+        round[k]    - dissemination round k done (gtmp2: counter decremented)
+        release     - gtmp_barrier() about to return
+    gtmp_finalize() folds the rings into a summary that separates arrival
+    skew (last arrival - first arrival: the workload) from release
+    propagation (last release - last arrival: the algorithm). The summary
+    is printed at exit; GTMP_TRACE_FILE=<path> also appends the raw rings
+    as CSV rows: experiment,thread,episode,arrive,round0..roundN,release.
+    Only threads 0..num_threads-1 of gtmp_trace_init are traced: phaser
+    parties that register later with a higher id (gtmp5) are skipped.
+*/
+#define GTMP_TRACE_EPISODES 1024
+#define GTMP_TRACE_MAX_ROUNDS 16
+
+#ifdef GTMP_TRACE
+void gtmp_trace_init(int num_threads, int rounds);
+void gtmp_trace_arrive(int thread_id);
+void gtmp_trace_round(int thread_id, int round);
+void gtmp_trace_release(int thread_id);
+void gtmp_trace_finalize();
+#else
+#define gtmp_trace_init(num_threads, rounds)
+#define gtmp_trace_arrive(thread_id)
+#define gtmp_trace_round(thread_id, round)
+#define gtmp_trace_release(thread_id)
+#define gtmp_trace_finalize()
+#endif
+
+#endif
@@ -3,10 +3,13 @@
 #include <omp.h>
 #include <time.h>
 #include "gtmp.h"
+#include "gtstats.h"
+#include "gtperf.h"
+#include "gtwork.h"
 
 int main(int argc, char** argv)
 {
-  struct timespec tstart, tend;
+  uint64_t tstart, tend;
   double dt;
 
   int num_threads;
@@ -33,11 +36,36 @@ int main(int argc, char** argv)
 
   omp_set_num_threads(num_threads);
 
+  // GT_WORK=<spec>: synthetic compute before every barrier (gtwork.h)
+  gtwork_t work;
+  int has_work = gtwork_from_env(&work);
+
+  // GT_FTQ=<quantum_ns>: OS noise on every thread before the experiments
+  if(getenv("GT_FTQ") != NULL){
+    uint64_t quantum = strtoull(getenv("GT_FTQ"), NULL, 10);
+    gtwork_ftq_t noise = {0};
+    #pragma omp parallel shared(noise)
+    {
+      gtwork_ftq_t mine;
+      gtwork_ftq(quantum, GTWORK_FTQ_SAMPLES, &mine);
+      #pragma omp critical
+      gtwork_ftq_merge(&noise, &mine);
+    }
+    gtwork_ftq_report(stdout, "OS noise", quantum, &noise);
+  }
+
+  // per-thread episode latencies, preallocated so the barrier loop never allocates
+  uint64_t **episodes = (uint64_t**)malloc(num_threads * sizeof(uint64_t*));
+  for (int t = 0; t < num_threads; t++)
+    episodes[t] = (uint64_t*)malloc(num_iter * sizeof(uint64_t));
+  gtstats_hist_t latency;
+  gtstats_hist_init(&latency);
+
   for (int j = 0; j < exp_iter; j++)
   {
     gtmp_init(num_threads);
 
-    clock_gettime(CLOCK_REALTIME, &tstart);
+    tstart = gtstats_now();
 
     /* ==============================================
     Parellel part
@@ -51,23 +79,68 @@ int main(int argc, char** argv)
         {
           pub += thread_num;
         }
+        if(has_work)
+          gtwork_run(&work, thread_num, num_threads, (uint64_t)j * num_iter + i);
 
+        uint64_t arrive = gtstats_now();
         gtmp_barrier();
+        episodes[thread_num][i] = gtstats_now() - arrive;
       }
     }
 
     /* ==============================================
     Timing check & clean up
     ==============================================*/
-    clock_gettime(CLOCK_REALTIME, &tend);
+    tend = gtstats_now();
     
-    dt = (tend.tv_sec*1e6+tend.tv_nsec/1e3)-(tstart.tv_sec*1e6+tstart.tv_nsec/1e3);
+    dt = (tend - tstart) / 1e3;
     total_time += dt;
 
+    for (int t = 0; t < num_threads; t++)
+      for (int k = 0; k < num_iter; k++)
+        gtstats_hist_record(&latency, episodes[t][k]);
+
     gtmp_finalize();
   }
 
   printf("Average time taken for %d experiments: %ld μs\n", exp_iter, total_time/exp_iter);
+  if(has_work)
+    printf("Workload: %s\n", work.spec);
+  gtstats_hist_report(stdout, "Barrier episode latency", &latency, getenv("GT_HIST") != NULL);
+
+  // GT_PERF=1: one extra, untimed pass with per-thread hardware counters
+  if(getenv("GT_PERF") != NULL){
+    int perf_iter = num_iter * 100;
+    gtperf_counts_t counts;
+    gtperf_counts_init(&counts);
+
+    gtmp_init(num_threads);
+    #pragma omp parallel shared(counts) firstprivate(thread_num)
+    {
+      gtperf_t perf;
+      gtperf_counts_t mine;
+      gtperf_counts_init(&mine);
+      thread_num = omp_get_thread_num();
+
+      gtperf_open(&perf);
+      gtmp_barrier(); // every thread has its counters before any starts
+      gtperf_start(&perf);
+      for(int k = 0; k < perf_iter; k++) // barriers only: a critical section here would be counted too
+        gtmp_barrier();
+      gtperf_stop(&perf, &mine);
+      gtperf_close(&perf);
+
+      #pragma omp critical
+      gtperf_counts_merge(&counts, &mine);
+    }
+    gtmp_finalize();
+
+    gtperf_report(stdout, "Barrier counters", &counts, perf_iter);
+  }
+
+  for (int t = 0; t < num_threads; t++)
+    free(episodes[t]);
+  free(episodes);
 
   return 0;
 }
\ No newline at end of file
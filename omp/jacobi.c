@@ -0,0 +1,123 @@
+#include <omp.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "gtmp.h"
+#include "gtjacobi.h"
+#include "gtstats.h"
+
+/*
+    Bulk-synchronous Jacobi mini-app (mp_jacobi). Every thread relaxes its
+    block of planes, then calls gtmp_barrier, then sums the partial
+    residuals of all threads: one barrier and one residual check per
+    iteration. The partials are double-buffered by iteration parity, so
+    no second barrier is needed before they are overwritten: a thread can
+    only write parity k again after everybody passed iteration k + 1's
+    barrier, i.e. after everybody read parity k.
+
+    It links against any gtmp barrier, like the harness; by default the
+    runtime-dispatched one (GTMP_BARRIER=<name>, see gtmp_auto.c).
+
+    Usage: ./mp_jacobi [-t threads] [-g grid] [-i iterations] [-e tolerance]
+    Defaults: every online CPU, 1024x1024, 1000 iterations, tolerance 0
+    (run every iteration).
+*/
+typedef struct{
+    double value;
+    char pad[56];
+} padded_t;
+
+int main(int argc, char **argv){
+    gtjacobi_grid_t grid;
+    char *spec = "1024x1024";
+    int num_threads = sysconf(_SC_NPROCESSORS_ONLN), iterations = 1000, opt;
+    double tolerance = 0;
+
+    while ((opt = getopt(argc, argv, "t:g:i:e:")) != -1)
+    {
+        switch (opt)
+        {
+            case 't': num_threads = strtol(optarg, NULL, 10); break;
+            case 'g': spec = optarg; break;
+            case 'i': iterations = strtol(optarg, NULL, 10); break;
+            case 'e': tolerance = strtod(optarg, NULL); break;
+            default:
+                fprintf(stderr, "Usage: %s [-t threads] [-g NXxNY[xNZ]] [-i iterations] [-e tolerance]\n", argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if (!gtjacobi_parse(&grid, spec) || num_threads < 1 || iterations < 1)
+    {
+        fprintf(stderr, "mp_jacobi: bad -t, -g or -i\n");
+        exit(EXIT_FAILURE);
+    }
+
+    double *a = gtjacobi_alloc(&grid, grid.planes, 1);
+    double *b = gtjacobi_alloc(&grid, grid.planes, 1);
+    padded_t *partial = (padded_t*)calloc(2 * num_threads, sizeof(padded_t));
+    padded_t *sync_ns = (padded_t*)calloc(num_threads, sizeof(padded_t));
+    if (a == NULL || b == NULL || partial == NULL || sync_ns == NULL)
+    {
+        fprintf(stderr, "mp_jacobi: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    omp_set_dynamic(0);
+    omp_set_num_threads(num_threads);
+    gtmp_init(num_threads);
+
+    int done = 0;
+    double residual = 0;
+    uint64_t start = gtstats_now();
+
+    #pragma omp parallel shared(done, residual)
+    {
+        int me = omp_get_thread_num(), first, last, k;
+        double *old = a, *new = b, *swap, sum = 0;
+
+        gtjacobi_split(grid.planes, num_threads, me, &first, &last);
+        for (k = 0; k < iterations; k++)
+        {
+            padded_t *mine = &partial[(k & 1) * num_threads];
+            mine[me].value = gtjacobi_sweep(&grid, old, new, first, last);
+
+            uint64_t arrive = gtstats_now();
+            gtmp_barrier();
+            sync_ns[me].value += gtstats_now() - arrive;
+
+            // residual check: every thread reaches the same verdict
+            sum = 0;
+            for (int t = 0; t < num_threads; t++)
+                sum += mine[t].value;
+            swap = old;
+            old = new;
+            new = swap;
+            if (sqrt(sum) < tolerance)
+            {
+                k++;
+                break;
+            }
+        }
+        if (me == 0)
+        {
+            done = k;
+            residual = sqrt(sum);
+        }
+    }
+    uint64_t wall = gtstats_now() - start;
+    gtmp_finalize();
+
+    double total = 0;
+    for (int t = 0; t < num_threads; t++)
+        total += sync_ns[t].value;
+
+    printf("%d threads\n", num_threads);
+    gtjacobi_report(stdout, &grid, done, residual, wall, total / num_threads);
+
+    free(a);
+    free(b);
+    free(partial);
+    free(sync_ns);
+    return 0;
+}
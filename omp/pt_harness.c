@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "gtmp.h"
+#include "gtaffinity.h"
+#include "gtstats.h"
+#include "gtwork.h"
+
+/*
+    pthreads harness (pt1 ... pt6): the omp harness's experiment on plain
+    pthreads built with -DGTMP_PTHREADS, without an OpenMP runtime. The
+    threads are created once, pinned according to GT_AFFINITY (see
+    gtaffinity.h), and run every experiment; a pthread barrier separates
+    the experiments so thread 0 can re-initialize the barrier under test.
+*/
+static int num_threads;
+static int num_iter = 100;
+static int exp_iter = 1e4;
+static long total_time = 0;
+static int pub = 0;
+static uint64_t **episodes;
+static gtstats_hist_t latency;
+static gtaffinity_t placement;
+static gtwork_t work;
+static int has_work;
+static int unpinned = 0;
+static pthread_barrier_t experiment;
+
+static void *worker(void *arg){
+  int thread_num = (int)(long)arg;
+  uint64_t tstart = 0;
+
+  gtmp_thread_register(thread_num);
+  if(!gtaffinity_pin(&placement, thread_num))
+    __atomic_fetch_add(&unpinned, 1, __ATOMIC_RELAXED);
+
+  for(int j = 0; j < exp_iter; j++){
+    pthread_barrier_wait(&experiment); // thread 0 has initialized the barrier
+    if(thread_num == 0)
+      tstart = gtstats_now();
+
+    for(int i = 0; i < num_iter; i++){
+      __atomic_fetch_add(&pub, thread_num, __ATOMIC_RELAXED);
+      if(has_work)
+        gtwork_run(&work, thread_num, num_threads, (uint64_t)j * num_iter + i);
+
+      uint64_t arrive = gtstats_now();
+      gtmp_barrier();
+      episodes[thread_num][i] = gtstats_now() - arrive;
+    }
+
+    pthread_barrier_wait(&experiment);
+    if(thread_num == 0){
+      total_time += (gtstats_now() - tstart) / 1000;
+      for(int t = 0; t < num_threads; t++)
+        for(int k = 0; k < num_iter; k++)
+          gtstats_hist_record(&latency, episodes[t][k]);
+      gtmp_finalize();
+      if(j < exp_iter - 1)
+        gtmp_init(num_threads);
+    }
+  }
+  return NULL;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2){
+    fprintf(stderr, "Usage: ./harness [NUM_THREADS]\n");
+    exit(EXIT_FAILURE);
+  }
+  num_threads = strtol(argv[1], NULL, 10);
+
+  if(argc > 2){ // to change number of iteration
+    num_iter = strtol(argv[2], NULL, 10);
+  }
+
+  // GT_AFFINITY=compact|scatter|<cpu list>: pin thread i (gtaffinity.h)
+  gtaffinity_from_env(&placement);
+  // GT_WORK=<spec>: synthetic compute before every barrier (gtwork.h)
+  has_work = gtwork_from_env(&work);
+
+  // per-thread episode latencies, preallocated so the barrier loop never allocates
+  episodes = (uint64_t**)malloc(num_threads * sizeof(uint64_t*));
+  for (int t = 0; t < num_threads; t++)
+    episodes[t] = (uint64_t*)malloc(num_iter * sizeof(uint64_t));
+  gtstats_hist_init(&latency);
+
+  pthread_t *threads = (pthread_t*)malloc(num_threads * sizeof(pthread_t));
+  pthread_barrier_init(&experiment, NULL, num_threads);
+  gtmp_init(num_threads);
+
+  // the main thread is thread 0
+  for (int t = 1; t < num_threads; t++)
+    pthread_create(&threads[t], NULL, worker, (void*)(long)t);
+  worker((void*)0);
+  for (int t = 1; t < num_threads; t++)
+    pthread_join(threads[t], NULL);
+
+  printf("Average time taken for %d experiments: %ld μs\n", exp_iter, total_time/exp_iter);
+  gtaffinity_report(stdout, &placement, num_threads);
+  if(unpinned > 0)
+    printf("Warning: %d threads could not be pinned\n", unpinned);
+  if(has_work)
+    printf("Workload: %s\n", work.spec);
+  gtstats_hist_report(stdout, "Barrier episode latency", &latency, getenv("GT_HIST") != NULL);
+
+  pthread_barrier_destroy(&experiment);
+  free(threads);
+  for (int t = 0; t < num_threads; t++)
+    free(episodes[t]);
+  free(episodes);
+
+  return 0;
+}
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include "gtsim.h"
+
+/*
+    gtsim: predicted barrier latency for node counts we cannot allocate.
+
+    For every algorithm and node count it builds one episode (gtsim_algos.c),
+    replays it under the LogGP model (gtsim_des.c) and prints a CSV row:
+        algorithm,nodes,ppn,endpoints,latency_us,messages,remote_messages
+
+    The default model approximates the InfiniBand HDR100 nodes of the
+    sbatch runs: fit net-L/net-o from a ping-pong (mpi3 with 2 ranks) and
+    shm-L from mp1 with 2 threads before trusting absolute numbers. The
+    ranking of algorithms is much less sensitive to them.
+*/
+static const char *default_nodes = "2,4,8,16,32,64,128,256,512,1024,2048,4096,8192,10000";
+
+static void usage(const char *argv0){
+    fprintf(stderr,
+        "Usage: %s [-a algo,...] [-n nodes,...] [-p ppn] [--bytes n]\n"
+        "          [--net-L ns] [--net-o ns] [--net-g ns] [--net-G ns]\n"
+        "          [--shm-L ns] [--shm-o ns] [--shm-g ns]\n"
+        "algorithms:\n", argv0);
+    for (int i = 0; i < gtsim_num_algos; i++)
+        fprintf(stderr, "  %-14s %s\n", gtsim_algos[i].name, gtsim_algos[i].description);
+    exit(EXIT_FAILURE);
+}
+
+static void simulate(const gtsim_algo_t *algo, int nodes, const gtsim_model_t *model){
+    int endpoints = nodes * model->ppn;
+    gtsim_program_t *programs = (gtsim_program_t*)calloc(endpoints, sizeof(gtsim_program_t));
+
+    algo->build(programs, nodes, model->ppn);
+    gtsim_result_t result = gtsim_run(programs, endpoints, model);
+    printf("%s,%d,%d,%d,%.3f,%ld,%ld\n", algo->name, nodes, model->ppn, endpoints,
+        result.latency_ns / 1e3, result.messages, result.remote);
+
+    for (int e = 0; e < endpoints; e++)
+        free(programs[e].ops);
+    free(programs);
+}
+
+int main(int argc, char **argv){
+    gtsim_model_t model = {
+        .net = { .L = 1000, .o = 250, .g = 100, .G = 0.08 },
+        .shm = { .L = 80, .o = 10, .g = 40, .G = 0 },
+        .ppn = 1,
+        .bytes = 1,
+    };
+    char *algos = NULL;
+    char *nodes = NULL;
+    static struct option options[] = {
+        { "algorithms", required_argument, 0, 'a' },
+        { "nodes", required_argument, 0, 'n' },
+        { "ppn", required_argument, 0, 'p' },
+        { "bytes", required_argument, 0, 'b' },
+        { "net-L", required_argument, 0, 1 },
+        { "net-o", required_argument, 0, 2 },
+        { "net-g", required_argument, 0, 3 },
+        { "net-G", required_argument, 0, 4 },
+        { "shm-L", required_argument, 0, 5 },
+        { "shm-o", required_argument, 0, 6 },
+        { "shm-g", required_argument, 0, 7 },
+        { 0, 0, 0, 0 }
+    };
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "a:n:p:b:h", options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+            case 'a': algos = optarg; break;
+            case 'n': nodes = optarg; break;
+            case 'p': model.ppn = strtol(optarg, NULL, 10); break;
+            case 'b': model.bytes = strtol(optarg, NULL, 10); break;
+            case 1: model.net.L = strtod(optarg, NULL); break;
+            case 2: model.net.o = strtod(optarg, NULL); break;
+            case 3: model.net.g = strtod(optarg, NULL); break;
+            case 4: model.net.G = strtod(optarg, NULL); break;
+            case 5: model.shm.L = strtod(optarg, NULL); break;
+            case 6: model.shm.o = strtod(optarg, NULL); break;
+            case 7: model.shm.g = strtod(optarg, NULL); break;
+            default: usage(argv[0]);
+        }
+    }
+    if (model.ppn < 1 || model.bytes < 1)
+        usage(argv[0]);
+
+    // algorithms and node counts are comma-separated lists
+    char *algo_list = strdup(algos != NULL ? algos : "");
+    if (algos == NULL)
+    {
+        for (int i = 0; i < gtsim_num_algos; i++)
+        {
+            algo_list = realloc(algo_list, strlen(algo_list) + strlen(gtsim_algos[i].name) + 2);
+            strcat(strcat(algo_list, i ? "," : ""), gtsim_algos[i].name);
+        }
+    }
+
+    printf("algorithm,nodes,ppn,endpoints,latency_us,messages,remote_messages\n");
+    for (char *name = strtok(algo_list, ","); name != NULL; name = strtok(NULL, ","))
+    {
+        const gtsim_algo_t *algo = gtsim_find_algo(name);
+        if (algo == NULL)
+        {
+            fprintf(stderr, "gtsim: unknown algorithm %s\n", name);
+            usage(argv[0]);
+        }
+        char *node_list = strdup(nodes != NULL ? nodes : default_nodes), *save;
+        for (char *count = strtok_r(node_list, ",", &save); count != NULL; count = strtok_r(NULL, ",", &save))
+        {
+            int n = strtol(count, NULL, 10);
+            if (n < 1)
+                usage(argv[0]);
+            simulate(algo, n, &model);
+        }
+        free(node_list);
+    }
+    free(algo_list);
+    return 0;
+}
@@ -0,0 +1,69 @@
+#ifndef GTSIM_H
+#define GTSIM_H
+
+/*
+    Discrete-event barrier simulator.
+
+    A barrier episode is a program per endpoint (an MPI rank or an OpenMP
+    thread): a list of sends and receives to named peers, built from the
+    same schedules the library uses (gtsim_algos.c). gtsim_run() replays
+    the programs under a LogGP cost model and returns when the last
+    endpoint leaves the barrier.
+
+    Endpoint e lives on node e / ppn. A message between two endpoints of
+    the same node uses the shared-memory link: L is a cache-to-cache line
+    transfer, o the store or load, and g the serialization of one writer
+    signalling several readers (invalidations, or a contended counter).
+    Messages between nodes use the network link.
+*/
+typedef struct{
+    double L; // latency, ns
+    double o; // send/receive overhead, ns
+    double g; // gap between consecutive sends, ns
+    double G; // gap per byte for long messages, ns
+} gtsim_link_t;
+
+typedef struct{
+    gtsim_link_t net;
+    gtsim_link_t shm;
+    int ppn;   // endpoints per node
+    int bytes; // payload of every message
+} gtsim_model_t;
+
+enum gtsim_op_kind{gtsim_send=1, gtsim_recv=2};
+#define GTSIM_ANY -1 // receive from whoever arrives first (a shared counter)
+
+typedef struct{
+    enum gtsim_op_kind kind;
+    int peer;
+} gtsim_op_t;
+
+typedef struct{
+    gtsim_op_t *ops;
+    int n;
+    int cap;
+} gtsim_program_t;
+
+typedef struct{
+    double latency_ns; // last endpoint out
+    long messages;
+    long remote;       // messages that crossed nodes
+} gtsim_result_t;
+
+// gtsim_des.c
+void gtsim_add(gtsim_program_t *program, enum gtsim_op_kind kind, int peer);
+gtsim_result_t gtsim_run(gtsim_program_t *programs, int endpoints, const gtsim_model_t *model);
+
+// gtsim_algos.c: build fills one program per endpoint (nodes * ppn)
+typedef struct{
+    const char *name;
+    const char *description;
+    void (*build)(gtsim_program_t *programs, int nodes, int ppn);
+} gtsim_algo_t;
+
+extern const gtsim_algo_t gtsim_algos[];
+extern const int gtsim_num_algos;
+
+const gtsim_algo_t *gtsim_find_algo(const char *name); // NULL if unknown
+
+#endif
@@ -0,0 +1,136 @@
+#include <string.h>
+#include "gtsim.h"
+#include "gtmpi_schedule.h"
+
+/*
+    One barrier episode per algorithm, as send/receive programs.
+
+    Group helpers place participant i of a group on endpoint
+    base + i * stride, so the same schedule runs over all endpoints (MPI
+    everywhere), over the threads of one node, or over one leader per node.
+*/
+
+// the tournament barrier of gtmpi2.c, replayed from the roles it builds
+static void tournament(gtsim_program_t *programs, int count, int base, int stride){
+    int num_rounds;
+
+    if (count < 2)
+        return;
+    round_t **rounds = gtmpi_tournament_schedule(count, &num_rounds);
+    for (int vpid = 0; vpid < count; vpid++)
+    {
+        gtsim_program_t *program = &programs[base + vpid * stride];
+        int round = 1, exit_arrival = 1;
+
+        while (exit_arrival) // arrival
+        {
+            int opponent = base + rounds[vpid][round].opponent * stride;
+            switch (rounds[vpid][round].role)
+            {
+                case loser:
+                    gtsim_add(program, gtsim_send, opponent);
+                    gtsim_add(program, gtsim_recv, opponent);
+                    exit_arrival = 0;
+                    break;
+                case winner:
+                    gtsim_add(program, gtsim_recv, opponent);
+                    break;
+                case champion:
+                    gtsim_add(program, gtsim_recv, opponent);
+                    gtsim_add(program, gtsim_send, opponent);
+                    exit_arrival = 0;
+                    break;
+                case bye:
+                case dropout:
+                    break;
+            }
+            if (exit_arrival)
+                round++;
+        }
+        for (round--; rounds[vpid][round].role != dropout; round--) // wakeup
+        {
+            if (rounds[vpid][round].role == winner)
+                gtsim_add(program, gtsim_send, base + rounds[vpid][round].opponent * stride);
+        }
+    }
+    gtmpi_free_schedule(rounds, count);
+}
+
+// radix-2 dissemination (gtmp1.c, combined1.c, combined4.c)
+static void dissemination(gtsim_program_t *programs, int count, int base, int stride){
+    for (int i = 0; i < count; i++)
+    {
+        for (int distance = 1; distance < count; distance *= 2)
+        {
+            gtsim_add(&programs[base + i * stride], gtsim_send, base + (i + distance) % count * stride);
+            gtsim_add(&programs[base + i * stride], gtsim_recv, base + (i - distance + count) % count * stride);
+        }
+    }
+}
+
+// centralized counter: everyone signals participant 0, which then releases everyone
+static void central_arrival(gtsim_program_t *programs, int count, int base, int stride){
+    for (int i = 1; i < count; i++)
+    {
+        gtsim_add(&programs[base + i * stride], gtsim_send, base);
+        gtsim_add(&programs[base], gtsim_recv, GTSIM_ANY);
+    }
+}
+
+static void central_release(gtsim_program_t *programs, int count, int base, int stride){
+    for (int i = 1; i < count; i++)
+    {
+        gtsim_add(&programs[base], gtsim_send, base + i * stride);
+        gtsim_add(&programs[base + i * stride], gtsim_recv, base);
+    }
+}
+
+static void build_tournament(gtsim_program_t *programs, int nodes, int ppn){
+    tournament(programs, nodes * ppn, 0, 1);
+}
+
+static void build_dissemination(gtsim_program_t *programs, int nodes, int ppn){
+    dissemination(programs, nodes * ppn, 0, 1);
+}
+
+static void build_central(gtsim_program_t *programs, int nodes, int ppn){
+    central_arrival(programs, nodes * ppn, 0, 1);
+    central_release(programs, nodes * ppn, 0, 1);
+}
+
+// combined1: threads disseminate, thread 0 of each node runs the tournament, then releases its node
+static void build_hier(gtsim_program_t *programs, int nodes, int ppn){
+    for (int n = 0; n < nodes; n++)
+        dissemination(programs, ppn, n * ppn, 1);
+    tournament(programs, nodes, 0, ppn);
+    for (int n = 0; n < nodes; n++)
+        central_release(programs, ppn, n * ppn, 1);
+}
+
+// combined2: a sense-reversing counter per node instead of dissemination
+static void build_hier_central(gtsim_program_t *programs, int nodes, int ppn){
+    for (int n = 0; n < nodes; n++)
+        central_arrival(programs, ppn, n * ppn, 1);
+    tournament(programs, nodes, 0, ppn);
+    for (int n = 0; n < nodes; n++)
+        central_release(programs, ppn, n * ppn, 1);
+}
+
+const gtsim_algo_t gtsim_algos[] = {
+    { "tournament", "MPI tournament over every endpoint (mpi2)", build_tournament },
+    { "dissemination", "flat dissemination over every endpoint (combined4, mp1 on one node)", build_dissemination },
+    { "central", "centralized counter and release over every endpoint", build_central },
+    { "hier", "per-node dissemination + tournament over nodes + release (combined1)", build_hier },
+    { "hier-central", "per-node counter + tournament over nodes + release (combined2)", build_hier_central },
+};
+
+const int gtsim_num_algos = sizeof(gtsim_algos) / sizeof(gtsim_algos[0]);
+
+const gtsim_algo_t *gtsim_find_algo(const char *name){
+    for (int i = 0; i < gtsim_num_algos; i++)
+    {
+        if (strcmp(gtsim_algos[i].name, name) == 0)
+            return &gtsim_algos[i];
+    }
+    return NULL;
+}
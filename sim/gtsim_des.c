@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "gtsim.h"
+
+/*
+    Event engine
+
+    Two kinds of events sit in a binary min-heap ordered by time:
+        resume   endpoint e may continue its program at time t
+        deliver  a message from src reaches dst at time t
+    A resumed endpoint runs its program until a receive finds no message
+    from its peer. A send costs the sender o (and the next send waits for
+    g), and schedules a deliver at start + o + L + (bytes - 1) * G. A receive
+    completes at max(now, arrival) + o. Receives name their source, so
+    messages are matched per (src, dst) in arrival order, as MPI does;
+    GTSIM_ANY takes the earliest message from anyone.
+*/
+enum event_kind{ev_resume, ev_deliver};
+
+typedef struct{
+    double time;
+    enum event_kind kind;
+    int endpoint; // resume: who, deliver: dst
+    int src;
+} event_t;
+
+typedef struct message{
+    int src;
+    double arrival;
+    struct message *next;
+} message_t;
+
+typedef struct{
+    int pc;
+    double clock;
+    double send_free; // earliest start of the next send (gap)
+    int blocked_on;   // peer of the pending receive, -2 if running
+    message_t *inbox; // delivered, not yet received, in arrival order
+    message_t *inbox_tail;
+} endpoint_t;
+
+static event_t *heap;
+static int heap_size, heap_cap;
+
+static void push(event_t ev){
+    if (heap_size == heap_cap)
+    {
+        heap_cap = heap_cap ? 2 * heap_cap : 1024;
+        heap = (event_t*)realloc(heap, heap_cap * sizeof(event_t));
+    }
+    int i = heap_size++;
+    while (i > 0 && heap[(i - 1) / 2].time > ev.time)
+    {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = ev;
+}
+
+static event_t pop(){
+    event_t top = heap[0], last = heap[--heap_size];
+    int i = 0;
+
+    for (;;)
+    {
+        int child = 2 * i + 1;
+        if (child >= heap_size)
+            break;
+        if (child + 1 < heap_size && heap[child + 1].time < heap[child].time)
+            child++;
+        if (heap[child].time >= last.time)
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = last;
+    return top;
+}
+
+void gtsim_add(gtsim_program_t *program, enum gtsim_op_kind kind, int peer){
+    if (program->n == program->cap)
+    {
+        program->cap = program->cap ? 2 * program->cap : 8;
+        program->ops = (gtsim_op_t*)realloc(program->ops, program->cap * sizeof(gtsim_op_t));
+    }
+    program->ops[program->n].kind = kind;
+    program->ops[program->n].peer = peer;
+    program->n++;
+}
+
+static const gtsim_link_t *link_between(const gtsim_model_t *model, int a, int b){
+    return a / model->ppn == b / model->ppn ? &model->shm : &model->net;
+}
+
+// remove and return the first message from src, NULL if none yet
+static message_t *take(endpoint_t *ep, int src){
+    message_t **prev = &ep->inbox, *last = NULL;
+
+    for (message_t *m = ep->inbox; m != NULL; last = m, prev = &m->next, m = m->next)
+    {
+        if (src != GTSIM_ANY && m->src != src)
+            continue;
+        *prev = m->next;
+        if (ep->inbox_tail == m)
+            ep->inbox_tail = last;
+        return m;
+    }
+    return NULL;
+}
+
+static void run(endpoint_t *eps, int e, gtsim_program_t *program, const gtsim_model_t *model, gtsim_result_t *result){
+    endpoint_t *ep = &eps[e];
+
+    while (ep->pc < program->n)
+    {
+        gtsim_op_t *op = &program->ops[ep->pc];
+
+        if (op->kind == gtsim_send)
+        {
+            const gtsim_link_t *link = link_between(model, e, op->peer);
+            double start = ep->clock > ep->send_free ? ep->clock : ep->send_free;
+            double gap = link->g + (model->bytes - 1) * link->G;
+            ep->clock = start + link->o;
+            ep->send_free = start + (gap > link->o ? gap : link->o);
+            push((event_t){ start + link->o + link->L + (model->bytes - 1) * link->G, ev_deliver, op->peer, e });
+            result->messages++;
+            if (link == &model->net)
+                result->remote++;
+        }
+        else
+        {
+            message_t *m = take(ep, op->peer);
+            if (m == NULL)
+            {
+                ep->blocked_on = op->peer;
+                return;
+            }
+            const gtsim_link_t *link = link_between(model, e, m->src);
+            ep->clock = (ep->clock > m->arrival ? ep->clock : m->arrival) + link->o;
+            free(m);
+        }
+        ep->pc++;
+    }
+}
+
+gtsim_result_t gtsim_run(gtsim_program_t *programs, int endpoints, const gtsim_model_t *model){
+    endpoint_t *eps = (endpoint_t*)calloc(endpoints, sizeof(endpoint_t));
+    gtsim_result_t result = { 0, 0, 0 };
+
+    heap_size = 0;
+    for (int e = 0; e < endpoints; e++)
+    {
+        eps[e].blocked_on = -2;
+        push((event_t){ 0, ev_resume, e, -1 }); // everyone arrives at t = 0
+    }
+
+    while (heap_size > 0)
+    {
+        event_t ev = pop();
+        endpoint_t *ep = &eps[ev.endpoint];
+
+        if (ev.kind == ev_deliver)
+        {
+            message_t *m = (message_t*)malloc(sizeof(message_t));
+            m->src = ev.src;
+            m->arrival = ev.time;
+            m->next = NULL;
+            if (ep->inbox_tail != NULL)
+                ep->inbox_tail->next = m;
+            else
+                ep->inbox = m;
+            ep->inbox_tail = m;
+            if (ep->blocked_on != ev.src && ep->blocked_on != GTSIM_ANY)
+                continue;
+            ep->blocked_on = -2;
+        }
+        run(eps, ev.endpoint, &programs[ev.endpoint], model, &result);
+    }
+
+    for (int e = 0; e < endpoints; e++)
+    {
+        if (eps[e].pc < programs[e].n)
+        {
+            fprintf(stderr, "gtsim: endpoint %d deadlocked waiting for %d\n", e, eps[e].blocked_on);
+            exit(EXIT_FAILURE);
+        }
+        if (eps[e].clock > result.latency_ns)
+            result.latency_ns = eps[e].clock;
+        while (eps[e].inbox != NULL)
+        {
+            message_t *m = eps[e].inbox;
+            eps[e].inbox = m->next;
+            free(m);
+        }
+    }
+    free(eps);
+    return result;
+}